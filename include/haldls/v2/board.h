@@ -91,6 +91,14 @@ struct VisitPreorderImpl<Board> {
 	}
 };
 
+template <>
+struct ConfigSizeInWords<Board> {
+	static constexpr std::size_t value =
+		halco::hicann_dls::v2::DACOnBoard::size * ConfigSizeInWords<DAC>::value +
+		ConfigSizeInWords<FlyspiConfig>::value + ConfigSizeInWords<FlyspiException>::value +
+		ConfigSizeInWords<SpikeRouter>::value;
+};
+
 } // namespace detail
 
 } // namespace v2
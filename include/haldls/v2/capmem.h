@@ -292,6 +292,12 @@ struct VisitPreorderImpl<CapMem> {
 	}
 };
 
+template <>
+struct ConfigSizeInWords<CapMem> {
+	static constexpr std::size_t value =
+		halco::hicann_dls::v2::CapMemCellOnDLS::size * ConfigSizeInWords<CapMemCell>::value;
+};
+
 } // namespace detail
 
 } // namespace v2
@@ -213,6 +213,25 @@ struct VisitPreorderImpl<Chip> {
 	}
 };
 
+template <>
+struct ConfigSizeInWords<Chip> {
+	static constexpr std::size_t value =
+		ConfigSizeInWords<CommonSynramConfig>::value +
+		halco::hicann_dls::v2::NeuronOnDLS::size * ConfigSizeInWords<NeuronDigitalConfig>::value +
+		halco::hicann_dls::v2::SynapseBlockOnDLS::size * ConfigSizeInWords<SynapseBlock>::value +
+		halco::hicann_dls::v2::ColumnBlockOnDLS::size *
+			(ConfigSizeInWords<ColumnCorrelationBlock>::value +
+			 ConfigSizeInWords<ColumnCurrentBlock>::value) +
+		halco::hicann_dls::v2::SynapseBlockOnDLS::size *
+			(ConfigSizeInWords<CausalCorrelationBlock>::value +
+			 ConfigSizeInWords<AcausalCorrelationBlock>::value) +
+		ConfigSizeInWords<CapMem>::value + ConfigSizeInWords<PPUMemory>::value +
+		ConfigSizeInWords<PPUControlRegister>::value + ConfigSizeInWords<PPUStatusRegister>::value +
+		ConfigSizeInWords<RateCounter>::value + ConfigSizeInWords<SynapseDriverBlock>::value +
+		ConfigSizeInWords<CapMemConfig>::value + ConfigSizeInWords<CommonNeuronConfig>::value +
+		ConfigSizeInWords<CorrelationConfig>::value;
+};
+
 } // namespace detail
 
 } // namespace v2
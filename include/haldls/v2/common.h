@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 #include <utility>
@@ -12,6 +14,9 @@ typedef std::uint32_t hardware_word_type;
 typedef std::uint64_t hardware_time_type;
 typedef std::uint8_t instruction_word_type;
 
+/// \brief Number of FPGA clock cycles per microsecond, the unit of hardware times (96 MHz).
+constexpr hardware_time_type fpga_clock_cycles_per_us = 96;
+
 struct ocp_address_type {
 	typedef std::uint32_t value_type;
 	value_type value;
@@ -56,6 +61,26 @@ struct VisitPreorderImpl {
 	}
 }; // VisitPreorderImpl
 
+template <typename ContainerT, typename WordT, std::size_t N, typename... Args>
+std::integral_constant<std::size_t, N> encoded_size_in_words(
+	std::array<WordT, N> (ContainerT::*)(Args...) const);
+
+/// \brief Number of words written to the hardware when encoding the specified container,
+///        including all containers visited by visit_preorder().
+/// For leaf-node containers the number of words is taken from the return type of their
+/// `encode` member function.
+/// \note This class needs to be specialized for non-leaf-node containers, consistent with
+///       their specialization of VisitPreorderImpl.
+template <class ContainerT>
+struct ConfigSizeInWords {
+	static_assert(
+		ContainerT::is_leaf_node::value,
+		"ConfigSizeInWords needs to be specialized for non-leaf-node container");
+
+	static constexpr std::size_t value =
+		decltype(encoded_size_in_words(&ContainerT::encode))::value;
+}; // ConfigSizeInWords
+
 } // namespace detail
 
 /// \brief Apply the specified visitor to all containers in a hierarchy by doing a
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "halco/common/genpybind.h"
@@ -11,8 +13,14 @@
 #include "haldls/v2/common.h"
 #include "haldls/v2/spike.h"
 #include "haldls/v2/synapse.h"
+#include "hate/optional.h"
 #include "hate/visibility.h"
 
+#ifdef __GENPYBIND_GENERATED__
+#include <stdexcept>
+#include <pybind11/numpy.h>
+#endif
+
 namespace stadls {
 namespace v2 {
 class LocalBoardControl;
@@ -53,10 +61,64 @@ public:
 		std::size_t length;
 	}; // ContainerTicket
 
+	/// \brief Ticket for a group of containers of the same type read consecutively.
+	/// \see PlaybackProgramBuilder::read_range()
+	template <typename T>
+	class ContainerVectorTicket
+	{
+	private:
+		friend PlaybackProgram;
+
+		typedef typename T::coordinate_type coordinate_type;
+
+		ContainerVectorTicket(
+			serial_number_type serial_number,
+			std::vector<coordinate_type> const& coords,
+			std::size_t offset,
+			std::size_t length)
+			: serial_number(serial_number), coords(coords), offset(offset), length(length)
+		{}
+
+		serial_number_type serial_number;
+		std::vector<coordinate_type> coords;
+		std::size_t offset;
+		/// Number of words per container.
+		std::size_t length;
+	}; // ContainerVectorTicket
+
+	/// \brief Ticket for a slot in the program whose written data can be replaced later.
+	/// \see PlaybackProgramBuilder::write_patchable(), PlaybackProgram::patch()
+	template <typename T>
+	class PatchTicket
+	{
+	private:
+		friend PlaybackProgram;
+
+		typedef typename T::coordinate_type coordinate_type;
+
+		PatchTicket(
+			serial_number_type serial_number,
+			coordinate_type const& coord,
+			std::size_t offset,
+			std::size_t length)
+			: serial_number(serial_number), coord(coord), offset(offset), length(length)
+		{}
+
+		serial_number_type serial_number;
+		coordinate_type coord;
+		/// Index of the first write instruction of the slot.
+		std::size_t offset;
+		/// Number of write instructions of the slot.
+		std::size_t length;
+	}; // PatchTicket
+
 #ifdef __GENPYBIND__
 // Explicit instantiation of template class for all valid playback container types.
 #define PLAYBACK_CONTAINER(Name, Type)                                                             \
-	typedef PlaybackProgram::ContainerTicket<Type> _##Name##ContainerTicket GENPYBIND(opaque);
+	typedef PlaybackProgram::ContainerTicket<Type> _##Name##ContainerTicket GENPYBIND(opaque);     \
+	typedef PlaybackProgram::ContainerVectorTicket<Type> _##Name##ContainerVectorTicket            \
+		GENPYBIND(opaque);                                                                         \
+	typedef PlaybackProgram::PatchTicket<Type> _##Name##PatchTicket GENPYBIND(opaque);
 #include "haldls/v2/container.def"
 #endif // __GENPYBIND__
 
@@ -70,15 +132,97 @@ public:
 	template <typename T>
 	T get(ContainerTicket<T> const& ticket) const;
 
+	/// \brief Decode the results referenced by the ticket into an existing container.
+	/// All data of the container read from the hardware is overwritten, this allows reusing
+	/// the container, e.g. when repeatedly reading back large containers.
+	template <typename T>
+	void get_into(ContainerTicket<T> const& ticket, T& config) const;
+
+	/// \brief Decode the results of all containers referenced by the ticket.
+	template <typename T>
+	std::vector<T> get(ContainerVectorTicket<T> const& ticket) const;
+
+	/// \brief Raw results words of all containers referenced by the ticket, in the order of
+	///        the coordinates passed to PlaybackProgramBuilder::read_range().
+	template <typename T>
+	std::vector<v2::hardware_word_type> get_words(ContainerVectorTicket<T> const& ticket) const;
+
+	/// \brief Replace the data written in the specified slot by the encoding of the given
+	///        container, modifying the instruction byte blocks in-place.
+	/// The serial number is kept, so tickets issued for this program remain valid. If the
+	/// program was transferred to a board already, LocalBoardControl::transfer() only re-sends
+	/// the modified byte ranges.
+	template <typename T>
+	void patch(PatchTicket<T> const& ticket, T const& config);
+
+	/// \brief Byte ranges [begin, end) of the instruction byte blocks modified by patch(),
+	///        in the order of modification.
+	std::vector<std::pair<std::size_t, std::size_t> > const& patched_byte_ranges() const
+		SYMBOL_VISIBLE;
+
+	typedef std::size_t patch_version_type;
+
+	/// \brief Version of the instruction byte blocks, unique among all programs and their
+	///        copies within the process. Each patch() and each copy yields a new version.
+	patch_version_type patch_version() const SYMBOL_VISIBLE;
+
+	/// \brief Number of patched byte ranges at the time this program had the given version,
+	///        unknown if the version does not stem from this program, e.g. from a copy.
+	hate::optional<std::size_t> patched_byte_range_count(patch_version_type version) const
+		SYMBOL_VISIBLE;
+
 	spikes_type const& get_spikes() const SYMBOL_VISIBLE;
 
+	/// \brief Join the programs into a single program executing them one after another.
+	/// Each program is preceded by set_time(0), i.e. its times are relative to its start, and
+	/// its halt instruction is dropped. Tickets issued for the original programs are
+	/// translated via rebase(), their spikes are available via get_spikes(serial_number).
+	/// \note All programs have to be terminated by halt().
+	static PlaybackProgram concat(std::vector<PlaybackProgram> const& programs) SYMBOL_VISIBLE;
+
+	/// \brief Translate a ticket issued for one of the programs joined via concat() to a ticket
+	///        of this program.
+	template <typename T>
+	ContainerTicket<T> rebase(ContainerTicket<T> const& ticket) const;
+
+	/// \see rebase(ContainerTicket<T> const&)
+	template <typename T>
+	ContainerVectorTicket<T> rebase(ContainerVectorTicket<T> const& ticket) const;
+
+	/// \brief Spikes recorded during the part of this program stemming from the program with
+	///        the given serial number, joined via concat().
+	spikes_type get_spikes(serial_number_type serial_number) const SYMBOL_VISIBLE;
+
 	serial_number_type serial_number() const SYMBOL_VISIBLE;
 
 	std::string dump_program() const SYMBOL_VISIBLE;
 
+	/// \brief Estimated execution time of the program on the hardware, given by the time
+	///        spent in wait instructions.
+	/// The timer is assumed to be zero at the beginning of the program, the execution time of
+	/// other instructions is neglected, i.e. the estimate is a lower bound.
+	std::chrono::microseconds estimated_duration() const SYMBOL_VISIBLE;
+
+	/// \brief Whether the program writes CapMem-related containers, i.e. CapMem, CapMemCell,
+	///        CapMemConfig or Chip, requiring the analog parameters to settle afterwards.
+	bool alters_capmem() const SYMBOL_VISIBLE;
+
+	/// \brief Instruction byte blocks of the complete program.
+	/// \note Programs split into segments exceed the SDRAM size and have to be executed
+	///       segment-wise, see segment_instruction_byte_blocks().
 	std::vector<std::vector<instruction_word_type> > const& instruction_byte_blocks() const
 		SYMBOL_VISIBLE;
 
+	/// \brief Number of segments the program was split into for execution, one if it was
+	///        not split.
+	/// \see PlaybackProgramBuilder::set_max_segment_size()
+	std::size_t segment_count() const SYMBOL_VISIBLE;
+
+	/// \brief Instruction byte blocks of the specified segment, each segment is executed
+	///        separately and its results are appended to the ones of the previous segments.
+	std::vector<std::vector<instruction_word_type> > const& segment_instruction_byte_blocks(
+		std::size_t segment) const SYMBOL_VISIBLE;
+
 	friend stadls::v2::LocalBoardControl;
 	friend PlaybackProgramBuilder;
 
@@ -90,6 +234,22 @@ private:
 	ContainerTicket<T> create_ticket(
 		typename T::coordinate_type const& coord, std::size_t offset, std::size_t length) const;
 
+	/// \see PlaybackProgramBuilder
+	template <typename T>
+	ContainerVectorTicket<T> create_vector_ticket(
+		std::vector<typename T::coordinate_type> const& coords,
+		std::size_t offset,
+		std::size_t length) const;
+
+	/// \see PlaybackProgramBuilder
+	template <typename T>
+	PatchTicket<T> create_patch_ticket(
+		typename T::coordinate_type const& coord, std::size_t offset, std::size_t length) const;
+
+	/// \brief Throw if the specified range of results is not available for the ticket.
+	void check_results(
+		serial_number_type ticket_serial_number, std::size_t offset, std::size_t length) const;
+
 	template <typename T>
 	static void ensure_container_invariants(T& config);
 
@@ -99,6 +259,14 @@ private:
 	/// \see LocalBoardControl
 	void set_spikes(spikes_type&& spikes) SYMBOL_VISIBLE;
 
+	/// \brief Number of set_time() instructions executed at the time each spike was recorded.
+	/// \see LocalBoardControl
+	void set_spike_set_time_counts(std::vector<std::size_t>&& counts) SYMBOL_VISIBLE;
+
+	/// \brief Number of words read by the program, used to preallocate results.
+	/// \see LocalBoardControl
+	std::size_t read_count() const SYMBOL_VISIBLE;
+
 	struct Impl;
 	std::unique_ptr<Impl> m_impl;
 	/// Serial number of the build, used to differentiate container tickets.
@@ -127,17 +295,99 @@ public:
 		halco::hicann_dls::v2::NeuronOnDLS const& neuron) SYMBOL_VISIBLE;
 	void halt() SYMBOL_VISIBLE;
 
+	/// \brief Fire all spikes of the train at their respective time.
+	/// Spikes are sorted by time, a wait instruction is only emitted when the time changes.
+	/// Spikes with equal time and source address are merged into a single fire instruction.
+	/// \note Times are absolute, i.e. relative to the last set_time() instruction.
+	void fire_spike_train(std::vector<v2::PlaybackSpike> spikes) SYMBOL_VISIBLE;
+
+	GENPYBIND_MANUAL({
+		parent.def(
+			"fire_spike_train",
+			[](GENPYBIND_PARENT_TYPE& self,
+			   pybind11::array_t<
+				   ::haldls::v2::hardware_time_type,
+				   pybind11::array::c_style | pybind11::array::forcecast> const& times,
+			   pybind11::array_t<
+				   uint_fast16_t, pybind11::array::c_style | pybind11::array::forcecast> const&
+				   source_addresses,
+			   pybind11::array_t<
+				   size_t, pybind11::array::c_style | pybind11::array::forcecast> const&
+				   synapse_drivers) {
+				if (times.ndim() != 1 || source_addresses.ndim() != 1 ||
+					synapse_drivers.ndim() != 1)
+					throw std::invalid_argument("spike train arrays have to be one-dimensional");
+				auto const size = static_cast<size_t>(times.shape(0));
+				if (static_cast<size_t>(source_addresses.shape(0)) != size ||
+					static_cast<size_t>(synapse_drivers.shape(0)) != size)
+					throw std::invalid_argument("spike train arrays differ in length");
+
+				auto const times_data = times.unchecked<1>();
+				auto const addresses_data = source_addresses.unchecked<1>();
+				auto const drivers_data = synapse_drivers.unchecked<1>();
+				std::vector<::haldls::v2::PlaybackSpike> spikes;
+				spikes.reserve(size);
+				for (size_t ii = 0; ii < size; ++ii) {
+					spikes.emplace_back(
+						times_data(ii),
+						::haldls::v2::SynapseBlock::Synapse::Address(addresses_data(ii)),
+						::halco::hicann_dls::v2::SynapseDriverOnDLS(drivers_data(ii)));
+				}
+				self.fire_spike_train(std::move(spikes));
+			},
+			pybind11::arg("times"), pybind11::arg("source_addresses"),
+			pybind11::arg("synapse_drivers"));
+	})
+
 	template <class T>
 	void write(typename T::coordinate_type const& coord, T const& config);
 
+	/// \brief Write the container and return a ticket allowing to replace the written data
+	///        in the finished program.
+	/// \see PlaybackProgram::patch()
+	template <class T>
+	PlaybackProgram::PatchTicket<T> write_patchable(
+		typename T::coordinate_type const& coord, T const& config);
+
+	/// \brief Emit write instructions only for those words of \c next whose encoding
+	///        differs from the encoding of \c previous.
+	/// \note The hardware is assumed to be configured according to \c previous already.
+	template <class T>
+	void write_diff(
+		typename T::coordinate_type const& coord, T const& previous, T const& next);
+
 	template <class T>
 	PlaybackProgram::ContainerTicket<T> read(typename T::coordinate_type const& coord) SYMBOL_VISIBLE;
 
+	/// \brief Read all containers at the specified coordinates, the results are available
+	///        via a single ticket.
+	template <class T>
+	PlaybackProgram::ContainerVectorTicket<T> read_range(
+		std::vector<typename T::coordinate_type> const& coords) SYMBOL_VISIBLE;
+
+	/// \brief Split programs into segments whose instructions and projected results each fit
+	///        into the given number of bytes, e.g. the size of the FPGA SDRAM.
+	/// Programs are only split in front of wait instructions following the first set_time(),
+	/// each segment restores the time of the previous segment at its beginning. Building a
+	/// program that cannot be split accordingly throws.
+	/// A size of zero (default) disables splitting.
+	/// \see PlaybackProgram::segment_count()
+	void set_max_segment_size(std::size_t bytes) SYMBOL_VISIBLE;
+	std::size_t get_max_segment_size() const SYMBOL_VISIBLE;
+
+	/// \brief Projected size of the instructions of the program built so far in bytes.
+	std::size_t instruction_byte_size() const SYMBOL_VISIBLE;
+
+	/// \brief Projected size of the results of the program built so far in bytes.
+	/// \note Spikes sent by the chip are not included.
+	std::size_t result_byte_size() const SYMBOL_VISIBLE;
+
 	PlaybackProgram done() SYMBOL_VISIBLE;
 
 private:
 	static std::atomic<PlaybackProgram::serial_number_type> next_serial_number;
 	PlaybackProgram m_program;
+	std::size_t m_max_segment_size = 0;
 }; // PlaybackProgramBuilder
 
 #ifdef __GENPYBIND__
@@ -145,10 +395,26 @@ private:
 #define PLAYBACK_CONTAINER(_Name, Type)                                                            \
 	extern template void PlaybackProgramBuilder::write<Type>(                                      \
 		Type::coordinate_type const&, Type const&);                                                \
+	extern template void PlaybackProgramBuilder::write_diff<Type>(                                 \
+		Type::coordinate_type const&, Type const&, Type const&);                                   \
+	extern template PlaybackProgram::PatchTicket<Type>                                             \
+	PlaybackProgramBuilder::write_patchable<Type>(Type::coordinate_type const&, Type const&);      \
+	extern template void PlaybackProgram::patch<Type>(                                             \
+		PlaybackProgram::PatchTicket<Type> const&, Type const&);                                   \
 	extern template PlaybackProgram::ContainerTicket<Type>                                         \
 	PlaybackProgramBuilder::read<Type>(Type::coordinate_type const&);                              \
+	extern template PlaybackProgram::ContainerVectorTicket<Type>                                   \
+	PlaybackProgramBuilder::read_range<Type>(std::vector<Type::coordinate_type> const&);           \
 	extern template Type PlaybackProgram::get(                                                     \
-		PlaybackProgram::ContainerTicket<Type> const& ticket) const;
+		PlaybackProgram::ContainerTicket<Type> const& ticket) const;                               \
+	extern template PlaybackProgram::ContainerTicket<Type> PlaybackProgram::rebase(                \
+		PlaybackProgram::ContainerTicket<Type> const& ticket) const;                               \
+	extern template void PlaybackProgram::get_into(                                                \
+		PlaybackProgram::ContainerTicket<Type> const& ticket, Type& config) const;                 \
+	extern template std::vector<Type> PlaybackProgram::get(                                        \
+		PlaybackProgram::ContainerVectorTicket<Type> const& ticket) const;                         \
+	extern template std::vector<hardware_word_type> PlaybackProgram::get_words(                    \
+		PlaybackProgram::ContainerVectorTicket<Type> const& ticket) const;
 #include "haldls/v2/container.def"
 #endif // __GENPYBIND__
 
@@ -150,6 +150,12 @@ struct VisitPreorderImpl<PPUMemory> {
 	}
 };
 
+template <>
+struct ConfigSizeInWords<PPUMemory> {
+	static constexpr std::size_t value =
+		halco::hicann_dls::v2::PPUMemoryWordOnDLS::size * ConfigSizeInWords<PPUMemoryWord>::value;
+};
+
 } // namespace detail
 
 } // namespace v2
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+namespace stadls {
+
+/// \brief Incremental 64 bit FNV-1a hash, each value passed to update() is folded in as a
+///        whole.
+/// \note Not collision-resistant, only suited to identify data within a single process.
+class Fnv1a
+{
+public:
+	typedef std::uint64_t value_type;
+
+	constexpr Fnv1a() : m_value(offset_basis) {}
+
+	void update(value_type const value)
+	{
+		m_value ^= value;
+		m_value *= prime;
+	}
+
+	template <typename IteratorT>
+	void update(IteratorT begin, IteratorT const end)
+	{
+		for (; begin != end; ++begin)
+			update(static_cast<value_type>(*begin));
+	}
+
+	value_type value() const { return m_value; }
+
+private:
+	static constexpr value_type offset_basis = 0xcbf29ce484222325ull;
+	static constexpr value_type prime = 0x100000001b3ull;
+
+	value_type m_value;
+}; // Fnv1a
+
+} // namespace stadls
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace stadls {
+
+/// \brief Associative container evicting the least recently used entries as soon as the
+///        accumulated size of all entries exceeds the configured bound.
+/// The size of an entry is specified by the user on insertion, e.g. the number of bytes
+/// occupied by the cached data.
+/// \note Not thread-safe, users have to provide their own synchronization.
+template <typename KeyT, typename ValueT, typename HashT = std::hash<KeyT> >
+class LRUCache
+{
+public:
+	typedef KeyT key_type;
+	typedef ValueT value_type;
+
+	explicit LRUCache(std::size_t max_size) : m_max_size(max_size), m_size(0) {}
+
+	/// \brief Look up the entry for the given key and mark it as most recently used.
+	/// \return Pointer to the cached value or nullptr if there is no such entry.
+	value_type* find(key_type const& key)
+	{
+		auto const it = m_index.find(key);
+		if (it == m_index.end())
+			return nullptr;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return &std::get<1>(*it->second);
+	}
+
+	/// \brief Insert or replace the entry for the given key and evict least recently used
+	///        entries until the size bound is satisfied again.
+	/// \note Entries larger than the size bound are not stored at all.
+	void insert(key_type const& key, value_type value, std::size_t size)
+	{
+		erase(key);
+		if (size > m_max_size)
+			return;
+		m_entries.emplace_front(key, std::move(value), size);
+		m_index.emplace(key, m_entries.begin());
+		m_size += size;
+		shrink();
+	}
+
+	void erase(key_type const& key)
+	{
+		auto const it = m_index.find(key);
+		if (it == m_index.end())
+			return;
+		m_size -= std::get<2>(*it->second);
+		m_entries.erase(it->second);
+		m_index.erase(it);
+	}
+
+	void clear()
+	{
+		m_index.clear();
+		m_entries.clear();
+		m_size = 0;
+	}
+
+	std::size_t entries() const { return m_entries.size(); }
+
+	std::size_t size() const { return m_size; }
+
+	std::size_t max_size() const { return m_max_size; }
+
+	void set_max_size(std::size_t value)
+	{
+		m_max_size = value;
+		shrink();
+	}
+
+private:
+	void shrink()
+	{
+		while (m_size > m_max_size && !m_entries.empty()) {
+			auto const& lru = m_entries.back();
+			m_size -= std::get<2>(lru);
+			m_index.erase(std::get<0>(lru));
+			m_entries.pop_back();
+		}
+	}
+
+	typedef std::list<std::tuple<key_type, value_type, std::size_t> > entries_type;
+
+	std::size_t m_max_size;
+	std::size_t m_size;
+	entries_type m_entries;
+	std::unordered_map<key_type, typename entries_type::iterator, HashT> m_index;
+}; // LRUCache
+
+} // namespace stadls
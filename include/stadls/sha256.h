@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace stadls {
+
+/// \brief Incremental SHA-256 digest (FIPS 180-4).
+/// Integral values passed to update_value() are folded in as little endian bytes.
+class Sha256
+{
+public:
+	typedef std::array<std::uint8_t, 32> digest_type;
+
+	Sha256()
+		: m_state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+		  m_block(),
+		  m_block_size(0),
+		  m_length(0)
+	{}
+
+	void update(std::uint8_t const* data, std::size_t size)
+	{
+		m_length += size;
+		while (size > 0) {
+			m_block[m_block_size++] = *data++;
+			--size;
+			if (m_block_size == m_block.size()) {
+				process_block();
+				m_block_size = 0;
+			}
+		}
+	}
+
+	template <typename IteratorT>
+	void update(IteratorT begin, IteratorT const end)
+	{
+		for (; begin != end; ++begin)
+			update_value(*begin);
+	}
+
+	template <typename T>
+	void update_value(T const value)
+	{
+		static_assert(std::is_integral<T>::value, "only integral values can be hashed");
+		typedef typename std::make_unsigned<T>::type unsigned_type;
+		auto const bits = static_cast<unsigned_type>(value);
+		std::uint8_t bytes[sizeof(T)];
+		for (std::size_t ii = 0; ii < sizeof(T); ++ii)
+			bytes[ii] = static_cast<std::uint8_t>(bits >> (8 * ii));
+		update(bytes, sizeof(T));
+	}
+
+	/// \brief Digest of all data passed so far, further data may still be appended.
+	digest_type digest() const
+	{
+		Sha256 final_state(*this);
+		std::uint64_t const length_in_bits = m_length * 8;
+
+		std::uint8_t const padding = 0x80;
+		final_state.update(&padding, 1);
+		std::uint8_t const zero = 0;
+		while (final_state.m_block_size != m_block.size() - sizeof(length_in_bits))
+			final_state.update(&zero, 1);
+		std::uint8_t length_bytes[sizeof(length_in_bits)];
+		for (std::size_t ii = 0; ii < sizeof(length_in_bits); ++ii)
+			length_bytes[ii] = static_cast<std::uint8_t>(
+				length_in_bits >> (8 * (sizeof(length_in_bits) - 1 - ii)));
+		final_state.update(length_bytes, sizeof(length_in_bits));
+
+		digest_type digest;
+		for (std::size_t ii = 0; ii < digest.size(); ++ii)
+			digest[ii] =
+				static_cast<std::uint8_t>(final_state.m_state[ii / 4] >> (24 - 8 * (ii % 4)));
+		return digest;
+	}
+
+private:
+	static std::uint32_t rotate_right(std::uint32_t const value, unsigned int const shift)
+	{
+		return (value >> shift) | (value << (32 - shift));
+	}
+
+	void process_block()
+	{
+		static constexpr std::uint32_t round_constants[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+			0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+			0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+			0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+			0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+			0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+			0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+			0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+			0xc67178f2};
+
+		std::uint32_t schedule[64];
+		for (std::size_t ii = 0; ii < 16; ++ii)
+			schedule[ii] = (static_cast<std::uint32_t>(m_block[4 * ii]) << 24) |
+			               (static_cast<std::uint32_t>(m_block[4 * ii + 1]) << 16) |
+			               (static_cast<std::uint32_t>(m_block[4 * ii + 2]) << 8) |
+			               static_cast<std::uint32_t>(m_block[4 * ii + 3]);
+		for (std::size_t ii = 16; ii < 64; ++ii) {
+			auto const s0 = rotate_right(schedule[ii - 15], 7) ^
+			                rotate_right(schedule[ii - 15], 18) ^ (schedule[ii - 15] >> 3);
+			auto const s1 = rotate_right(schedule[ii - 2], 17) ^
+			                rotate_right(schedule[ii - 2], 19) ^ (schedule[ii - 2] >> 10);
+			schedule[ii] = schedule[ii - 16] + s0 + schedule[ii - 7] + s1;
+		}
+
+		auto state = m_state;
+		for (std::size_t ii = 0; ii < 64; ++ii) {
+			auto const s1 =
+				rotate_right(state[4], 6) ^ rotate_right(state[4], 11) ^ rotate_right(state[4], 25);
+			auto const choice = (state[4] & state[5]) ^ (~state[4] & state[6]);
+			auto const t1 = state[7] + s1 + choice + round_constants[ii] + schedule[ii];
+			auto const s0 =
+				rotate_right(state[0], 2) ^ rotate_right(state[0], 13) ^ rotate_right(state[0], 22);
+			auto const majority =
+				(state[0] & state[1]) ^ (state[0] & state[2]) ^ (state[1] & state[2]);
+			auto const t2 = s0 + majority;
+			for (std::size_t jj = 7; jj > 0; --jj)
+				state[jj] = state[jj - 1];
+			state[4] += t1;
+			state[0] = t1 + t2;
+		}
+		for (std::size_t ii = 0; ii < m_state.size(); ++ii)
+			m_state[ii] += state[ii];
+	}
+
+	std::array<std::uint32_t, 8> m_state;
+	std::array<std::uint8_t, 64> m_block;
+	std::size_t m_block_size;
+	std::uint64_t m_length;
+}; // Sha256
+
+} // namespace stadls
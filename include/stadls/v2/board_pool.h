@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "haldls/v2/board.h"
+#include "haldls/v2/chip.h"
+#include "haldls/v2/playback.h"
+#include "hate/visibility.h"
+
+namespace stadls {
+namespace v2 GENPYBIND(tag(stadls_v2)) {
+
+/// \brief Board and chip configuration and the playback program of a single experiment.
+struct GENPYBIND(visible) PoolExperiment
+{
+	haldls::v2::Board board;
+	haldls::v2::Chip chip;
+	haldls::v2::PlaybackProgram playback_program;
+};
+
+/// \brief Executes experiments in parallel on multiple boards, one I/O thread per board.
+/// Experiments are distributed round-robin over per-board queues, idle boards steal queued
+/// experiments from the back of the queues of busy boards, so all boards are kept busy even
+/// if the runtime of the experiments differs.
+class GENPYBIND(visible) BoardPool
+{
+public:
+	/// \brief Open all boards of the allocation.
+	/// \see available_board_usb_serial_numbers()
+	BoardPool() SYMBOL_VISIBLE;
+
+	/// \brief Open the boards with the given usb serials.
+	BoardPool(std::vector<std::string> const& usb_serial_numbers) SYMBOL_VISIBLE;
+
+	BoardPool(BoardPool&& other) noexcept SYMBOL_VISIBLE;
+	BoardPool& operator=(BoardPool&& other) noexcept SYMBOL_VISIBLE;
+
+	BoardPool(BoardPool const& other) = delete;
+	BoardPool& operator=(BoardPool const& other) = delete;
+
+	/// \brief Finishes all submitted experiments.
+	~BoardPool() SYMBOL_VISIBLE;
+
+	std::size_t size() const SYMBOL_VISIBLE;
+	std::vector<std::string> usb_serials() const SYMBOL_VISIBLE;
+
+	/// \brief Enqueue the experiment for execution on any of the boards and return
+	///        immediately.
+	/// \return Future of the experiment with results available, exceptions during execution
+	///         are rethrown by the future.
+	std::future<PoolExperiment> submit(PoolExperiment experiment) SYMBOL_VISIBLE
+		GENPYBIND(hidden);
+
+	/// \brief Execute all experiments, distributed over the boards.
+	/// \return Experiments with results available, in order of the given experiments
+	std::vector<PoolExperiment> map(std::vector<PoolExperiment> experiments) SYMBOL_VISIBLE;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> m_impl;
+}; // BoardPool
+
+} // namespace v2
+} // namespace stadls
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "haldls/v2/board.h"
+#include "haldls/v2/chip.h"
+#include "haldls/v2/common.h"
+#include "hate/visibility.h"
+#include "stadls/lru_cache.h"
+
+namespace stadls {
+namespace v2 {
+
+/// \brief Process-wide cache of encoded static configuration data.
+/// Entries are keyed by a hash of the encoded configuration words of the respective
+/// container, on a hit the cached encoding is returned without building a new program.
+/// The encoded words are compared against the cached ones, so hash collisions result in a
+/// miss instead of wrong configuration data.
+class ConfigurationCache
+{
+public:
+	typedef std::vector<std::vector<haldls::v2::instruction_word_type> > program_bytes_type;
+
+	struct BoardWords
+	{
+		std::vector<haldls::v2::ocp_address_type> addresses;
+		std::vector<haldls::v2::ocp_word_type> words;
+	};
+
+	struct Statistics
+	{
+		std::size_t hits;
+		std::size_t misses;
+		std::size_t entries;
+		std::size_t size_in_bytes;
+		/// Sum of the bounds of the chip and board entries.
+		std::size_t max_size_in_bytes;
+	};
+
+	/// \brief Default bound for the memory used by the cached entries, applied separately to
+	///        chip and board entries.
+	static constexpr std::size_t default_max_size_in_bytes = 64 * 1024 * 1024;
+
+	static ConfigurationCache& instance() SYMBOL_VISIBLE;
+
+	/// \brief Instruction byte blocks of the chip configuration program, not waiting for the
+	///        cap-mem to settle.
+	/// \see get_configure_program(), LocalBoardControl::configure_static()
+	std::shared_ptr<program_bytes_type const> get_configure_program_bytes(
+		haldls::v2::Chip const& chip) SYMBOL_VISIBLE;
+
+	/// \brief OCP addresses and words of the board configuration.
+	std::shared_ptr<BoardWords const> get_board_words(haldls::v2::Board const& board)
+		SYMBOL_VISIBLE;
+
+	Statistics get_statistics() const SYMBOL_VISIBLE;
+	void reset_statistics() SYMBOL_VISIBLE;
+
+	/// \brief Set the memory bound for all cached entries, evicting least recently used
+	///        entries if necessary.
+	void set_max_size_in_bytes(std::size_t value) SYMBOL_VISIBLE;
+
+	void clear() SYMBOL_VISIBLE;
+
+private:
+	ConfigurationCache();
+
+	struct ChipEntry
+	{
+		std::vector<haldls::v2::hardware_word_type> words;
+		std::shared_ptr<program_bytes_type const> bytes;
+	};
+
+	typedef LRUCache<std::uint64_t, ChipEntry> chip_cache_type;
+	typedef LRUCache<std::uint64_t, std::shared_ptr<BoardWords const> > board_cache_type;
+
+	mutable std::mutex m_mutex;
+	chip_cache_type m_chip_cache;
+	board_cache_type m_board_cache;
+	std::size_t m_hits;
+	std::size_t m_misses;
+}; // ConfigurationCache
+
+} // namespace v2
+} // namespace stadls
@@ -12,7 +12,7 @@
 
 namespace stadls {
 namespace v2 GENPYBIND(tag(stadls_v2)) {
-haldls::v2::PlaybackProgram get_configure_program(haldls::v2::Chip chip);
+haldls::v2::PlaybackProgram get_configure_program(haldls::v2::Chip const& chip);
 
 class GENPYBIND(visible) ExperimentControl
 {
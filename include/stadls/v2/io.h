@@ -7,5 +7,6 @@ GENPYBIND_MANUAL({
 	parent->py::module::import("pyhaldls_v2");
 })
 
+#include "board_pool.h"
 #include "experiment.h"
 #include "local_board_control.h"
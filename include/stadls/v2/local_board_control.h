@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -15,7 +16,55 @@
 namespace stadls {
 namespace v2 { // GENPYBIND(tag(stadls_v2)) {
 
-haldls::v2::PlaybackProgram get_configure_program(haldls::v2::Chip chip);
+haldls::v2::PlaybackProgram get_configure_program(haldls::v2::Chip const& chip)
+	SYMBOL_VISIBLE;
+
+/// \brief Chip configuration program waiting for the given number of FPGA clock cycles for
+///        the cap-mem to settle, no wait is emitted if zero.
+haldls::v2::PlaybackProgram get_configure_program(
+	haldls::v2::Chip const& chip, haldls::v2::hardware_time_type capmem_settle_time)
+	SYMBOL_VISIBLE;
+
+/// \brief Words identifying the analog configuration of the cap-mem, i.e. the encoded
+///        CapMem and CapMemConfig containers of the chip followed by the values of the board
+///        DACs supplying the cap-mem (capmem_i_buf_bias, capmem_i_offset and capmem_i_ref).
+std::vector<haldls::v2::hardware_word_type> get_capmem_words(
+	haldls::v2::Board const& board, haldls::v2::Chip const& chip) SYMBOL_VISIBLE;
+
+/// \brief Completion detection by busy-polling the execute flag, trading CPU time for low and
+///        stable latency of short programs.
+struct GENPYBIND(visible) SpinPolling
+{
+	/// \brief Time to busy-poll the execute flag before falling back to sleeping.
+	std::chrono::microseconds spin_budget{1000};
+	/// \brief CPU to pin the I/O thread of the board to, which executes asynchronous runs.
+	/// Synchronous executions poll on the I/O thread as well if set, the calling thread
+	/// blocks until completion is detected.
+	/// \see LocalBoardControl::run_async()
+	hate::optional<std::size_t> cpu;
+};
+
+/// \brief Timing of the completion detection of an execution.
+struct GENPYBIND(visible) ExecutionStatistics
+{
+	/// \brief Time from setting the execute flag until its clearing was detected.
+	std::chrono::nanoseconds completion_latency{0};
+	/// \brief Number of reads of the execute flag.
+	std::size_t polls = 0;
+	/// \brief Whether completion was detected while busy-polling.
+	bool spun = false;
+};
+
+/// \brief Usage of the programs kept resident in the FPGA SDRAM.
+struct GENPYBIND(visible) ResidentProgramStatistics
+{
+	std::size_t hits = 0;
+	std::size_t misses = 0;
+	std::size_t evictions = 0;
+	std::size_t entries = 0;
+	/// \brief Size of all resident programs in SDRAM words.
+	std::size_t size = 0;
+};
 
 class GENPYBIND(visible) LocalBoardControl
 {
@@ -36,6 +85,18 @@ public:
 	/// \brief toggle soft reset and chip reset and restore fpga to default config
 	void soft_reset() SYMBOL_VISIBLE;
 
+	/// \brief Write the board configuration and execute the chip configuration program, which
+	///        must not wait for the cap-mem to settle itself.
+	/// The cap-mem settle duration is only waited for if the given CapMem-related words
+	/// differ from the ones last applied.
+	/// \see get_configure_program(), get_capmem_words()
+	void configure_static(
+		std::vector<haldls::v2::ocp_address_type> const& board_addresses,
+		std::vector<haldls::v2::ocp_word_type> const& board_words,
+		std::vector<std::vector<haldls::v2::instruction_word_type> > const& chip_program_bytes,
+		std::vector<haldls::v2::hardware_word_type> const& chip_capmem_words) SYMBOL_VISIBLE;
+	/// \brief Configure without knowledge of the CapMem-related words, always waiting for the
+	///        cap-mem to settle.
 	void configure_static(
 		std::vector<haldls::v2::ocp_address_type> const& board_addresses,
 		std::vector<haldls::v2::ocp_word_type> const& board_words,
@@ -44,15 +105,56 @@ public:
 	void configure_static(haldls::v2::Board const& board, haldls::v2::Chip const& chip)
 		SYMBOL_VISIBLE;
 
-	/// \brief transfers the program and sets the program size and address
-	///        registers
+	/// \brief Time to wait for the cap-mem to settle after its configuration changed,
+	///        defaults to 2'000'000 FPGA clock cycles (~ 20.8 ms).
+	void set_capmem_settle_duration(std::chrono::microseconds value) SYMBOL_VISIBLE;
+	std::chrono::microseconds get_capmem_settle_duration() const SYMBOL_VISIBLE;
+
+	/// \brief Forget the CapMem-related configuration last applied by configure_static().
+	/// The shadow is invalidated by soft_reset(), errors during execution and playback
+	/// programs altering the cap-mem. This function has to be called if raw program bytes
+	/// writing CapMem-related containers are transferred.
+	/// \see haldls::v2::PlaybackProgram::alters_capmem()
+	void invalidate_capmem_shadow() SYMBOL_VISIBLE;
+
+	/// \brief Forget the board configuration last written by configure_static().
+	/// Only words differing from that configuration are written to the board, the shadow is
+	/// invalidated by soft_reset() and errors during execution. This function has to be
+	/// called if the board is configured otherwise, e.g. via OCP writes.
+	/// The FPGA configuration is tracked alongside, execute() only checks the DLS reset flag
+	/// on the board if it is unknown.
+	void invalidate_board_shadow() SYMBOL_VISIBLE;
+
+	/// \brief Forget all state of the board known from previous operations, i.e. the board
+	///        and CapMem-related configuration and the resident programs.
+	/// This function has to be called if the board is accessed other than via this object.
+	void invalidate() SYMBOL_VISIBLE;
+
+	/// \brief transfers the program unless the same bytes are still resident in the SDRAM
+	///        and sets the program size and address registers
 	void transfer(std::vector<std::vector<haldls::v2::instruction_word_type> > const& program_bytes)
 		SYMBOL_VISIBLE;
+	/// \brief transfers the program unless it is still present on the board from a previous
+	///        transfer, in which case only the byte ranges modified by
+	///        PlaybackProgram::patch() since then are re-sent
 	void transfer(haldls::v2::PlaybackProgram const& playback_program) SYMBOL_VISIBLE;
 
+	/// \brief Transferred programs are kept resident in the SDRAM until the space is needed,
+	///        evicting the least recently used programs first.
+	/// Resident programs are dropped by soft_reset() and run_pipelined().
+	ResidentProgramStatistics get_resident_program_statistics() const SYMBOL_VISIBLE;
+	void reset_resident_program_statistics() SYMBOL_VISIBLE;
+
 	/// \brief toggle the execute flag and wait until turned off again
 	void execute() SYMBOL_VISIBLE;
 
+	/// \brief Busy-poll the execute flag before sleeping, disabled if not set (default).
+	void set_spin_polling(hate::optional<SpinPolling> const& spin_polling) SYMBOL_VISIBLE;
+	hate::optional<SpinPolling> get_spin_polling() const SYMBOL_VISIBLE;
+
+	/// \brief Timing of the completion detection of the last execution.
+	ExecutionStatistics get_last_execution_statistics() const SYMBOL_VISIBLE;
+
 	/// \brief toggle the execute flag and wait until turned off again
 	///        given timing parameter
 	/// \param min_wait_time Minimal wait time between checks of execute flag
@@ -77,14 +179,54 @@ public:
 	std::vector<haldls::v2::instruction_word_type> run(
 		std::vector<std::vector<haldls::v2::instruction_word_type> > const& program_byte)
 		SYMBOL_VISIBLE;
+	/// \brief Programs split into segments are executed segment by segment, their results and
+	///        spikes are joined as if the program was executed at once.
+	/// \see haldls::v2::PlaybackProgramBuilder::set_max_segment_size()
 	void run(haldls::v2::PlaybackProgram& playback_program) SYMBOL_VISIBLE;
 
+	/// \brief Run the programs back to back, alternating between the given number of SDRAM
+	///        program and result regions.
+	/// The next program is transferred and the results of the previous program are fetched
+	/// while the current program is executed, keeping both the chip and the USB link busy.
+	/// \return Programs with results and spikes available
+	std::vector<haldls::v2::PlaybackProgram> run_pipelined(
+		std::vector<haldls::v2::PlaybackProgram> playback_programs, std::size_t regions = 2)
+		SYMBOL_VISIBLE;
+
+	/// \brief Execute the program the given number of times, transferring it once and
+	///        fetching the results of all repetitions at once.
+	/// The results of the repetitions are accumulated in the SDRAM and have to fit into it
+	/// altogether.
+	/// \return Result bytes of each repetition, which are made available via the tickets of
+	///         the program by decode_result_bytes()
+	std::vector<std::vector<haldls::v2::instruction_word_type> > run_repeated(
+		haldls::v2::PlaybackProgram const& playback_program, std::size_t repetitions)
+		SYMBOL_VISIBLE;
+
 	/// \brief Run experiment on given board and chip
 	void run_experiment(
 		haldls::v2::Board const& board,
 		haldls::v2::Chip const& chip,
 		haldls::v2::PlaybackProgram& playback_program) SYMBOL_VISIBLE;
 
+	/// \brief Enqueue run() for execution on the I/O thread of this board and return
+	///        immediately.
+	/// Runs are executed in order of submission, exceptions are rethrown by the returned
+	/// future. The program has to outlive the execution of the run.
+	/// \note Other member functions throw std::logic_error while asynchronous runs are
+	///       pending, further runs may still be enqueued. Moving the object waits for all
+	///       pending runs to finish.
+	std::future<void> run_async(haldls::v2::PlaybackProgram& playback_program) SYMBOL_VISIBLE
+		GENPYBIND(hidden);
+
+	/// \brief Enqueue run_experiment() for execution on the I/O thread of this board.
+	/// Board and chip configuration are copied on submission.
+	/// \see run_async()
+	std::future<void> run_experiment_async(
+		haldls::v2::Board const& board,
+		haldls::v2::Chip const& chip,
+		haldls::v2::PlaybackProgram& playback_program) SYMBOL_VISIBLE GENPYBIND(hidden);
+
 	constexpr static char const* const env_name_board_id = "FLYSPI_ID";
 
 private:
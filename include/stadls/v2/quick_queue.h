@@ -1,15 +1,21 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "rcf-extensions/round-robin.h"
 
 #include "hate/visibility.h"
 
+#include "stadls/lru_cache.h"
+#include "stadls/sha256.h"
+#include "stadls/v2/configuration_cache.h"
 #include "stadls/v2/local_board_control.h"
 
 namespace SF {
@@ -24,13 +30,52 @@ namespace v2 GENPYBIND(tag(stadls_v2)) {
 typedef std::vector<haldls::v2::ocp_address_type> ocp_addresses_type;
 typedef std::vector<haldls::v2::ocp_word_type> ocp_words_type;
 typedef std::vector<std::vector<haldls::v2::instruction_word_type> > program_bytes_type;
+typedef std::vector<haldls::v2::hardware_word_type> capmem_words_type;
+typedef std::vector<haldls::v2::instruction_word_type> compressed_payload_type;
+typedef Sha256::digest_type configuration_digest_type;
+
+/// \brief Payloads of requests and responses are optionally transferred compressed with
+///        zstd, if quiggeldy and the client are built with compression support.
+/// The client selects the compression level of the request, the worker compresses the
+/// response with the same level. A level of zero disables compression. Payloads exceeding
+/// QuickQueueClient::max_message_length when decompressed are rejected.
+bool quick_queue_compression_available() SYMBOL_VISIBLE;
 
 struct QuickQueueRequest
 {
 	ocp_addresses_type board_addresses;
 	ocp_words_type board_words;
+	/// Chip configuration program not waiting for the cap-mem to settle, the worker waits
+	/// only if the CapMem-related words changed.
 	program_bytes_type chip_program_bytes;
+	capmem_words_type chip_capmem_words;
 	program_bytes_type playback_program_bytes;
+	bool playback_program_alters_capmem = false;
+
+	/// Digest of the board and chip configuration.
+	/// \see quick_queue_configuration_digest()
+	configuration_digest_type configuration_digest{};
+	/// The configuration is omitted, the worker uses the configuration of an earlier
+	/// request of the same user with the same digest or answers with a configuration miss.
+	bool configuration_omitted = false;
+
+	/// \brief Drop the board and chip configuration, keeping only its digest.
+	void omit_configuration() SYMBOL_VISIBLE;
+
+	/// Credential of the submitting user, the worker shares configurations only between
+	/// requests of the same user.
+	/// \see quick_queue_user_data()
+	std::string user_data;
+
+	/// Compression level of the program bytes, which are transferred in the compressed
+	/// payload if non-zero.
+	int compression_level = 0;
+	compressed_payload_type compressed_payload;
+
+	/// \brief Move the chip and playback program bytes into the compressed payload.
+	void compress(int level) SYMBOL_VISIBLE;
+	/// \brief Restore the chip and playback program bytes from the compressed payload.
+	void decompress() SYMBOL_VISIBLE;
 
 	template <class Archive>
 	void serialize(Archive& archive)
@@ -52,6 +97,22 @@ struct QuickQueueResponse
 {
 	std::vector<haldls::v2::instruction_word_type> result_bytes;
 
+	/// Compression level of the result bytes, which are transferred in the compressed
+	/// payload if non-zero.
+	int compression_level = 0;
+	compressed_payload_type compressed_payload;
+	/// Set by workers without compression support if the request was compressed, the client
+	/// has to resend the request uncompressed.
+	bool compression_unsupported = false;
+	/// Set if the configuration of the request was omitted and is unknown to the worker, the
+	/// client has to resend the request including the configuration.
+	bool configuration_miss = false;
+
+	/// \brief Move the result bytes into the compressed payload.
+	void compress(int level) SYMBOL_VISIBLE;
+	/// \brief Restore the result bytes from the compressed payload.
+	void decompress() SYMBOL_VISIBLE;
+
 	template <class Archive>
 	void serialize(Archive& archive)
 	{
@@ -68,10 +129,20 @@ private:
 	void serialize_detail(Archive& archive, std::false_type) SYMBOL_VISIBLE;
 };
 
+/// \brief SHA-256 digest over the board addresses and words, the chip program bytes and the
+///        CapMem-related words of the request.
+configuration_digest_type quick_queue_configuration_digest(QuickQueueRequest const& request)
+	SYMBOL_VISIBLE;
+
+/// \brief Credential identifying the current user to the worker, munge-encoded if built
+///        with munge support.
+/// \note Munge credentials can only be verified once, each request needs a new one.
+std::string quick_queue_user_data() SYMBOL_VISIBLE;
+
 QuickQueueRequest create_request(
 	haldls::v2::Board const& board,
 	haldls::v2::Chip const& chip,
-	haldls::v2::PlaybackProgram& playback_program);
+	haldls::v2::PlaybackProgram& playback_program) SYMBOL_VISIBLE;
 
 class QuickQueueWorker
 {
@@ -102,6 +173,20 @@ public:
 	// empty results are returned.
 	void set_mock_mode(bool mode_enable) SYMBOL_VISIBLE { m_mock_mode = mode_enable; };
 
+	/// \brief Time to wait for the cap-mem to settle after its configuration changed.
+	/// \see LocalBoardControl::set_capmem_settle_duration()
+	void set_capmem_settle_duration(std::chrono::microseconds value) SYMBOL_VISIBLE;
+
+	/// \brief The configurations of recent requests are kept by user and digest, so clients
+	///        only have to upload a configuration unknown to the worker.
+	/// Hits and misses count requests omitting their configuration.
+	ConfigurationCache::Statistics get_configuration_cache_statistics() const SYMBOL_VISIBLE;
+	void reset_configuration_cache_statistics() SYMBOL_VISIBLE;
+
+	/// \brief Set the memory bound for the kept configurations, evicting least recently
+	///        used configurations if necessary.
+	void set_configuration_cache_max_size_in_bytes(std::size_t value) SYMBOL_VISIBLE;
+
 private:
 	// methods
 	std::string get_slurm_jobname() { return "board_alloc_" + get_slurm_gres(); }
@@ -109,6 +194,14 @@ private:
 	void get_slurm_allocation();
 	void free_slurm_allocation();
 
+	struct Configuration
+	{
+		ocp_addresses_type board_addresses;
+		ocp_words_type board_words;
+		program_bytes_type chip_program_bytes;
+		capmem_words_type chip_capmem_words;
+	};
+
 	// members
 	std::unique_ptr<LocalBoardControl> m_local_board_ctrl;
 	std::string m_usb_serial;
@@ -117,6 +210,18 @@ private:
 	std::string m_slurm_partition;
 
 	bool m_mock_mode;
+	std::optional<std::chrono::microseconds> m_capmem_settle_duration;
+
+	typedef std::pair<std::size_t, configuration_digest_type> configuration_key_type;
+
+	struct ConfigurationKeyHash
+	{
+		std::size_t operator()(configuration_key_type const& key) const;
+	};
+
+	LRUCache<configuration_key_type, Configuration, ConfigurationKeyHash> m_configuration_cache;
+	std::size_t m_configuration_cache_hits;
+	std::size_t m_configuration_cache_misses;
 
 }; // QuickQueueWorker
 
@@ -145,11 +250,23 @@ public:
 		haldls::v2::Chip const& chip,
 		haldls::v2::PlaybackProgram& playback_program) SYMBOL_VISIBLE;
 
+	/// \brief Compression level of the request and response payloads, zero disables
+	///        compression.
+	/// Defaults to the value of the environment variable QUIGGELDY_COMPRESSION_LEVEL if set and
+	/// to default_compression_level if built with compression support, otherwise to zero.
+	/// Compression is disabled if the server does not support it.
+	void set_compression_level(int level) SYMBOL_VISIBLE;
+	int get_compression_level() const SYMBOL_VISIBLE;
+
+	static int const default_compression_level = 3;
+
 	static int const max_message_length = 1280 * 1024 * 1024;
 	static int const remote_call_timeout = 3600 * 1000;
 
 	constexpr static char const* const env_name_ip = "QUIGGELDY_IP";
 	constexpr static char const* const env_name_port = "QUIGGELDY_PORT";
+	constexpr static char const* const env_name_compression_level =
+		"QUIGGELDY_COMPRESSION_LEVEL";
 
 private:
 	class Impl;
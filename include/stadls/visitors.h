@@ -2,12 +2,37 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <iterator>
 #include <stdexcept>
 #include <utility>
 
 namespace stadls {
 
+/// \brief Non-owning view of a contiguous range of words, e.g. to decode configuration
+///        data in-place using DecodeVisitor.
+/// \note The viewed memory has to outlive the span.
+template <typename T>
+class Span
+{
+public:
+	typedef T value_type;
+	typedef T const* const_iterator;
+
+	Span(T const* data, std::size_t size) : m_data(data), m_size(size) {}
+
+	const_iterator begin() const { return m_data; }
+	const_iterator end() const { return m_data + m_size; }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+
+	std::size_t size() const { return m_size; }
+
+private:
+	T const* m_data;
+	std::size_t m_size;
+};
+
 /// \brief Extract addresses for reading from hardware for the visited containers.
 /// Each container can provide addresses via a `read_addresses` member function or via a
 /// `addresses` member function in case the addresses for reading and writing are the same.
@@ -93,6 +118,7 @@ struct WriteAddressVisitor
 /// \endcode
 /// \see ReadAddressVisitor, which is used to extract the addresses to read the
 ///      configuration data from.
+/// \see Span, which can be used to decode data without copying it beforehand.
 template <typename T>
 class DecodeVisitor
 {
@@ -142,7 +168,8 @@ private:
 		if (N > remaining())
 			throw std::runtime_error("end of buffer during decoding");
 
-		std::array<value_type, N> buf{{}};
+		// No value-initialization, as all elements are overwritten below.
+		std::array<value_type, N> buf;
 
 		auto prev_it = m_it;
 		std::advance(m_it, N);
@@ -211,4 +238,76 @@ private:
 	}
 };
 
+/// \brief Extract pairs of address and configuration data for writing to hardware for the
+///        visited containers in a single traversal.
+/// Addresses are extracted as in WriteAddressVisitor, words as in EncodeVisitor.  As both
+/// are combined per container, a mismatch of their number is detected at compile time.
+/// `T` is expected to be a container of `std::pair<address, word>`, which can be
+/// preallocated using `haldls::v2::detail::ConfigSizeInWords`.
+/// Containers that do not themselves contain data (i.e. containers of containers) can
+/// alternatively be tagged via
+/// \code
+/// typedef std::false_type has_local_data;
+/// \endcode
+template <typename T>
+class WriteEncodeVisitor
+{
+	T& m_data;
+	typedef typename T::value_type value_type;
+	typedef typename value_type::first_type address_type;
+	typedef typename value_type::second_type word_type;
+
+public:
+	WriteEncodeVisitor(T& data) : m_data(data) {}
+
+	template <typename CoordinateT, typename ContainerT>
+	auto operator()(CoordinateT const& coord, ContainerT const& container)
+		-> decltype(container.addresses(coord), &ContainerT::encode, void())
+	{
+		append(container.addresses(coord), encode(coord, container, &ContainerT::encode));
+	}
+
+	template <typename CoordinateT, typename ContainerT>
+	auto operator()(CoordinateT const& coord, ContainerT const& container)
+		-> decltype(container.write_addresses(coord), &ContainerT::encode, void())
+	{
+		append(container.write_addresses(coord), encode(coord, container, &ContainerT::encode));
+	}
+
+	template <typename CoordinateT, typename ContainerT>
+	auto operator()(CoordinateT const&, ContainerT const&) ->
+		typename std::enable_if<!ContainerT::has_local_data::value>::type
+	{
+		/* do nothing */
+	}
+
+private:
+	template <size_t N>
+	void append(
+		std::array<address_type, N> const& addresses, std::array<word_type, N> const& words)
+	{
+		for (size_t ii = 0; ii < N; ++ii) {
+			m_data.emplace_back(addresses[ii], words[ii]);
+		}
+	}
+
+	template <typename CoordinateT, typename ContainerT, size_t N>
+	std::array<word_type, N> encode(
+		CoordinateT const& coord,
+		ContainerT const& container,
+		std::array<word_type, N> (ContainerT::*encode)(CoordinateT const&) const)
+	{
+		return (container.*encode)(coord);
+	}
+
+	template <typename CoordinateT, typename ContainerT, size_t N>
+	std::array<word_type, N> encode(
+		CoordinateT const&,
+		ContainerT const& container,
+		std::array<word_type, N> (ContainerT::*encode)() const)
+	{
+		return (container.*encode)();
+	}
+};
+
 } // namespace stadls
@@ -1,6 +1,7 @@
 #!/usr/bin/env python
 
 import unittest
+import numpy as np
 import pyhalco_common as Co
 import pyhalco_hicann_dls_v2 as C
 import pyhaldls_v2 as Ct
@@ -40,6 +41,28 @@ class TestPyhaldlsIOV2(unittest.TestCase):
         with self.assertRaises(ValueError):
             capmem_copy = program_.get(capmem_ticket)
 
+    def test_fire_spike_train(self):
+        address = Ct.SynapseBlock.Synapse.Address
+        spikes = [Ct.PlaybackSpike(200, address(3), C.SynapseDriverOnDLS(1)),
+                  Ct.PlaybackSpike(100, address(5), C.SynapseDriverOnDLS(2)),
+                  Ct.PlaybackSpike(200, address(3), C.SynapseDriverOnDLS(4))]
+
+        builder = Ct.PlaybackProgramBuilder()
+        builder.fire_spike_train(spikes)
+        builder.halt()
+        program = builder.done()
+
+        builder.fire_spike_train(
+            np.array([200, 100, 200], dtype=np.uint64),
+            np.array([3, 5, 3]),
+            np.array([1, 2, 4]))
+        builder.halt()
+        numpy_program = builder.done()
+        self.assertEqual(program.dump_program(), numpy_program.dump_program())
+
+        with self.assertRaises(ValueError):
+            builder.fire_spike_train(np.array([1, 2]), np.array([3]), np.array([4, 5]))
+
 
 if __name__ == "__main__":
     logger.reset()
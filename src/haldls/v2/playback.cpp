@@ -1,6 +1,11 @@
 #include "haldls/v2/playback.h"
 
+#include <algorithm>
+#include <iterator>
 #include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "uni/decoder.h"
 #include "uni/program_builder.h"
@@ -14,27 +19,556 @@
 #include "haldls/v2/ppu.h"
 #include "haldls/v2/rate_counter.h"
 #include "haldls/v2/synapsedriver.h"
+#include "hate/optional.h"
 #include "stadls/visitors.h"
 
 namespace haldls {
 namespace v2 {
 
+namespace {
+
+typedef std::vector<instruction_word_type> byte_block_type;
+typedef std::vector<byte_block_type> byte_blocks_type;
+typedef uni::Program_builder<uni::Byte_vector_allocator> builder_type;
+
+/// \brief Whether writing the container alters the analog parameters held by the capacitive
+///        memory, which take some time to settle.
+template <typename T>
+struct AltersCapMem
+	: std::integral_constant<
+		  bool,
+		  std::is_same<T, CapMem>::value || std::is_same<T, CapMemCell>::value ||
+			  std::is_same<T, CapMemConfig>::value || std::is_same<T, Chip>::value>
+{};
+
+/// \brief Kind of an encoded instruction, as far as relevant for modifying programs.
+enum class InstructionKind
+{
+	write,
+	set_time,
+	halt,
+	other
+};
+
+/// \brief Location of an encoded instruction within the byte stream formed by all instruction
+///        byte blocks of a program.
+/// Instructions are not aligned to the blocks, i.e. they may span multiple blocks.
+struct InstructionPosition
+{
+	InstructionKind kind;
+	std::size_t offset;
+	std::size_t length;
+};
+
+/// \brief Iterator over the byte stream formed by all instruction byte blocks, keeping track
+///        of the furthest position reached, which after decoding an instruction corresponds
+///        to the end of its encoding.
+class ByteStreamIterator
+{
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef instruction_word_type value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef instruction_word_type const* pointer;
+	typedef instruction_word_type const& reference;
+
+	static ByteStreamIterator begin(byte_blocks_type const& blocks, std::size_t& position)
+	{
+		ByteStreamIterator it(blocks, 0, 0, position);
+		it.skip_empty_blocks();
+		return it;
+	}
+
+	static ByteStreamIterator end(byte_blocks_type const& blocks, std::size_t& position)
+	{
+		std::size_t size = 0;
+		for (auto const& block : blocks)
+			size += block.size();
+		return ByteStreamIterator(blocks, blocks.size(), size, position);
+	}
+
+	reference operator*() const { return (*m_blocks)[m_block][m_offset]; }
+
+	ByteStreamIterator& operator++()
+	{
+		++m_offset;
+		++m_index;
+		skip_empty_blocks();
+		*m_position = std::max(*m_position, m_index);
+		return *this;
+	}
+
+	ByteStreamIterator operator++(int)
+	{
+		auto const tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	bool operator==(ByteStreamIterator const& other) const { return m_index == other.m_index; }
+	bool operator!=(ByteStreamIterator const& other) const { return m_index != other.m_index; }
+
+private:
+	ByteStreamIterator(
+		byte_blocks_type const& blocks,
+		std::size_t block,
+		std::size_t index,
+		std::size_t& position)
+		: m_blocks(&blocks), m_block(block), m_offset(0), m_index(index), m_position(&position)
+	{}
+
+	void skip_empty_blocks()
+	{
+		while (m_block < m_blocks->size() && m_offset == (*m_blocks)[m_block].size()) {
+			++m_block;
+			m_offset = 0;
+		}
+	}
+
+	byte_blocks_type const* m_blocks;
+	std::size_t m_block;
+	std::size_t m_offset;
+	std::size_t m_index;
+	std::size_t* m_position;
+};
+
+/// \brief Collect the locations of all decoded instructions.
+struct InstructionPositionDecoder
+{
+	std::size_t const& position;
+	std::vector<InstructionPosition>& positions;
+
+	template <typename T>
+	void operator()(T const& /*inst*/)
+	{
+		push_back(InstructionKind::other);
+	}
+
+	void operator()(uni::Write_inst const& /*inst*/) { push_back(InstructionKind::write); }
+
+	void operator()(uni::Set_time_inst const& /*inst*/) { push_back(InstructionKind::set_time); }
+
+	void operator()(uni::Halt_inst const& /*inst*/) { push_back(InstructionKind::halt); }
+
+private:
+	void push_back(InstructionKind const kind)
+	{
+		std::size_t const begin =
+			positions.empty() ? 0 : positions.back().offset + positions.back().length;
+		positions.push_back({kind, begin, position - begin});
+	}
+};
+
+std::vector<InstructionPosition> find_instruction_positions(byte_blocks_type const& blocks)
+{
+	std::vector<InstructionPosition> positions;
+	std::size_t position = 0;
+	InstructionPositionDecoder decoder{position, positions};
+	uni::decode(
+		ByteStreamIterator::begin(blocks, position), ByteStreamIterator::end(blocks, position),
+		decoder);
+	return positions;
+}
+
+/// \brief Encoding of all instructions emitted by the given function.
+template <typename EmitF>
+byte_block_type encode_instructions(EmitF&& emit)
+{
+	uni::Byte_vector_allocator alloc;
+	builder_type bld(alloc);
+	emit(bld);
+
+	auto const positions = find_instruction_positions(bld.containers);
+	if (positions.empty())
+		throw std::logic_error("unexpected encoding of instructions");
+
+	byte_block_type bytes;
+	for (auto const& block : bld.containers)
+		bytes.insert(bytes.end(), block.cbegin(), block.cend());
+	bytes.resize(positions.back().offset + positions.back().length);
+	return bytes;
+}
+
+/// \brief Size of the encoding of the instructions emitted by the given function.
+template <typename EmitF>
+std::size_t encoded_size(EmitF&& emit)
+{
+	return encode_instructions(std::forward<EmitF>(emit)).size();
+}
+
+/// \brief Sizes of the encodings of instructions not depending on their arguments.
+struct InstructionSizes
+{
+	std::size_t write;
+	std::size_t read;
+	std::size_t fire;
+	std::size_t fire_one;
+	std::size_t halt;
+};
+
+InstructionSizes const& instruction_sizes()
+{
+	static InstructionSizes const sizes{
+		encoded_size([](builder_type& bld) { bld.write(0, 0); }),
+		encoded_size([](builder_type& bld) { bld.read(0); }),
+		encoded_size(
+			[](builder_type& bld) { bld.fire(0, v2::SynapseBlock::Synapse::Address(0)); }),
+		encoded_size(
+			[](builder_type& bld) { bld.fire_one(0, v2::SynapseBlock::Synapse::Address(0)); }),
+		encoded_size([](builder_type& bld) { bld.halt(); })};
+	return sizes;
+}
+
+/// \brief Size of the instruction byte blocks of generated programs, corresponds to the SDRAM
+///        block size used for transfers.
+std::size_t const transfer_block_size = 4096 * sizeof(hardware_word_type);
+
+/// \brief Pad the byte stream to full SDRAM words and split it into blocks for transfer.
+byte_blocks_type split_into_blocks(byte_block_type bytes)
+{
+	bytes.resize(
+		(bytes.size() + sizeof(hardware_word_type) - 1) / sizeof(hardware_word_type) *
+		sizeof(hardware_word_type));
+
+	byte_blocks_type blocks;
+	for (auto it = bytes.cbegin(); it != bytes.cend();) {
+		auto const size = std::min(
+			transfer_block_size, static_cast<std::size_t>(std::distance(it, bytes.cend())));
+		blocks.emplace_back(it, std::next(it, size));
+		std::advance(it, size);
+	}
+	return blocks;
+}
+
+/// \brief Overwrite the byte stream formed by the blocks starting at the given offset.
+/// \return Whether any byte was changed.
+bool overwrite_bytes(byte_blocks_type& blocks, std::size_t offset, byte_block_type const& bytes)
+{
+	bool changed = false;
+	auto block_it = blocks.begin();
+	while (offset >= block_it->size()) {
+		offset -= block_it->size();
+		++block_it;
+	}
+	for (auto const byte : bytes) {
+		while (offset == block_it->size()) {
+			offset = 0;
+			++block_it;
+		}
+		auto& target = (*block_it)[offset];
+		changed = changed || (target != byte);
+		target = byte;
+		++offset;
+	}
+	return changed;
+}
+
+} // namespace
+
 struct PlaybackProgram::Impl
 {
 	typedef v2::hardware_word_type hardware_word_type;
 	typedef v2::hardware_address_type hardware_address_type;
 
-	Impl() : bld(alloc) {}
+	typedef PlaybackProgramBuilder::time_type time_type;
+
+	Impl() : bld(alloc) { add_patch_version(); }
+
+	/// \brief Copy the program, the copy starts a new history of patch versions.
+	Impl(Impl const& other) = default;
+	static std::unique_ptr<Impl> copy(Impl const& other)
+	{
+		std::unique_ptr<Impl> impl(new Impl(other));
+		impl->patch_versions.clear();
+		impl->add_patch_version();
+		return impl;
+	}
+
+	/// \brief Record a new patch version for the current state of the instruction bytes.
+	void add_patch_version()
+	{
+		patch_versions.emplace_back(next_patch_version.fetch_add(1), patched_byte_ranges.size());
+	}
+
+	void write(hardware_address_type const address, hardware_word_type const word)
+	{
+		bld.write(address, word);
+		++write_count;
+		account(instruction_sizes().write, 0);
+	}
+
+	void read(hardware_address_type const address)
+	{
+		bld.read(address);
+		// The result of each read is recorded as a write instruction.
+		account(instruction_sizes().read, instruction_sizes().write);
+	}
+
+	void set_time(time_type const t)
+	{
+		auto const begin = emitted_bytes();
+		bld.set_time(t);
+		account_timing(emitted_bytes() - begin);
+		time = t;
+		estimated_time = t;
+	}
+
+	void wait_until(time_type const t)
+	{
+		auto const begin = emitted_bytes();
+		bld.wait_until(t);
+		account_timing(emitted_bytes() - begin);
+		time = t;
+		// Waiting for a time already passed returns immediately
+		if (t > estimated_time) {
+			elapsed_time += t - estimated_time;
+			estimated_time = t;
+		}
+	}
+
+	void wait_for(time_type const t)
+	{
+		auto const begin = emitted_bytes();
+		bld.wait_for(t);
+		account_timing(emitted_bytes() - begin);
+		if (time)
+			*time += t;
+		elapsed_time += t;
+		estimated_time += t;
+	}
+
+	void fire(unsigned long const mask, v2::SynapseBlock::Synapse::Address const& address)
+	{
+		bld.fire(mask, address);
+		account(instruction_sizes().fire, instruction_sizes().fire);
+	}
+
+	void fire_one(std::size_t const index, v2::SynapseBlock::Synapse::Address const& address)
+	{
+		bld.fire_one(index, address);
+		account(instruction_sizes().fire_one, instruction_sizes().fire_one);
+	}
+
+	void halt()
+	{
+		bld.halt();
+		account(instruction_sizes().halt, instruction_sizes().halt);
+	}
+
+	/// \brief Location between two instructions the program may be split at.
+	struct SplitPoint
+	{
+		/// Size of the preceding instructions, i.e. byte offset of the location, and projected
+		/// size of their results.
+		std::size_t instruction_bytes;
+		std::size_t result_bytes;
+		/// Time to be restored at the beginning of a segment starting at the location.
+		time_type time;
+	};
+
+	SplitPoint current_point() const
+	{
+		return {instruction_bytes, result_bytes, time ? *time : 0};
+	}
+
+	/// \brief Register the current location, i.e. in front of a wait instruction, as safe to
+	///        split the program at.
+	/// If the current segment exceeded the maximal size, the program is split at the previous
+	/// safe location. Locations at unknown time, i.e. prior to the first set_time(), are skipped.
+	void add_safe_point(std::size_t const max_segment_size)
+	{
+		if (max_segment_size == 0 || !time)
+			return;
+
+		auto const point = current_point();
+		split_if_exceeded(point, max_segment_size);
+		safe_point = point;
+	}
+
+	/// \brief Split the program at the last safe location if the segment ending at the given
+	///        location exceeds the maximal size.
+	void split_if_exceeded(SplitPoint const& end, std::size_t const max_segment_size)
+	{
+		if (!exceeds(end, max_segment_size))
+			return;
+
+		std::size_t const begin = split_points.empty() ? 0 : split_points.back().instruction_bytes;
+		if (safe_point && safe_point->instruction_bytes > begin) {
+			split_points.push_back(*safe_point);
+			auto const t = safe_point->time;
+			segment_prologue_size = encoded_size([t](builder_type& b) { b.set_time(t); });
+			if (!exceeds(end, max_segment_size))
+				return;
+		}
+		throw std::logic_error(
+			"program segment exceeds maximal size without wait instruction to split at");
+	}
+
+	/// \brief Whether the segment starting at the last split point and ending at the given
+	///        location exceeds the maximal size in instruction or result bytes.
+	bool exceeds(SplitPoint const& end, std::size_t const max_segment_size) const
+	{
+		SplitPoint const begin = split_points.empty() ? SplitPoint{0, 0, 0} : split_points.back();
+		// Segments are enclosed by set_time() and halt() instructions.
+		std::size_t const overhead = instruction_sizes().halt + segment_prologue_size;
+		return (end.instruction_bytes - begin.instruction_bytes + overhead > max_segment_size) ||
+			   (end.result_bytes - begin.result_bytes + overhead > max_segment_size);
+	}
+
+	/// \brief Split the finished program at the determined split points into separately
+	///        executable segments.
+	/// Each segment but the first starts with restoring the time at its split point, each
+	/// segment but the last is terminated by a halt instruction.
+	void split_into_segments(std::size_t const max_segment_size)
+	{
+		if (max_segment_size == 0)
+			return;
+
+		split_if_exceeded(current_point(), max_segment_size);
+		if (split_points.empty())
+			return;
+
+		auto const positions = find_instruction_positions(bld.containers);
+		for (auto const& split_point : split_points) {
+			auto const it = std::lower_bound(
+				positions.cbegin(), positions.cend(), split_point.instruction_bytes,
+				[](InstructionPosition const& position, std::size_t const offset) {
+					return position.offset < offset;
+				});
+			if (it == positions.cend() || it->offset != split_point.instruction_bytes)
+				throw std::logic_error("unable to locate split point in program");
+		}
+
+		byte_block_type bytes;
+		for (auto const& block : bld.containers)
+			bytes.insert(bytes.end(), block.cbegin(), block.cend());
+
+		auto const halt = encode_instructions([](builder_type& b) { b.halt(); });
+
+		auto begin = bytes.cbegin();
+		for (std::size_t ii = 0; ii <= split_points.size(); ++ii) {
+			byte_block_type segment;
+			if (ii > 0) {
+				auto const t = split_points[ii - 1].time;
+				segment = encode_instructions([t](builder_type& b) { b.set_time(t); });
+			}
+			if (ii < split_points.size()) {
+				auto const end = std::next(bytes.cbegin(), split_points[ii].instruction_bytes);
+				segment.insert(segment.end(), begin, end);
+				segment.insert(segment.end(), halt.cbegin(), halt.cend());
+				begin = end;
+			} else {
+				segment.insert(segment.end(), begin, bytes.cend());
+			}
+			segments.push_back(split_into_blocks(std::move(segment)));
+		}
+	}
 
 	uni::Byte_vector_allocator alloc;
-	uni::Program_builder<uni::Byte_vector_allocator> bld;
+	builder_type bld;
 
 	/// \brief Offset for the result of the next read instruction, i.e. number of already
 	///        executed read instructions.
 	size_t read_offset = 0;
 
+	/// \brief Number of already emitted write instructions, used to identify patch slots.
+	size_t write_count = 0;
+
+	/// \brief Size of the emitted instructions and projected size of the results recorded
+	///        during their execution in bytes.
+	/// Results comprise read data as well as fire and timing instructions, spikes sent by the
+	/// chip are not known in advance.
+	size_t instruction_bytes = 0;
+	size_t result_bytes = 0;
+
+	/// \brief Time after the last emitted timing instruction, unknown prior to set_time().
+	hate::optional<time_type> time;
+
+	/// \brief Estimated timer value and time spent waiting since the start of the program,
+	///        assuming the timer to start at zero. The execution time of instructions other
+	///        than waits is neglected.
+	time_type estimated_time = 0;
+	time_type elapsed_time = 0;
+
+	/// \brief Whether CapMem-related containers are written by the program.
+	bool alters_capmem = false;
+
+	/// \brief Locations the program is split at, in increasing order.
+	std::vector<SplitPoint> split_points;
+
+	/// \brief Last location the program can be split at.
+	hate::optional<SplitPoint> safe_point;
+
+	/// \brief Size of the set_time() instructions restoring the time at the beginning of the
+	///        segment starting at the last split point, zero for the first segment.
+	std::size_t segment_prologue_size = 0;
+
+	/// \brief Instruction byte blocks of the separately executed segments, empty if the
+	///        program was not split.
+	/// \see PlaybackProgramBuilder::set_max_segment_size()
+	std::vector<byte_blocks_type> segments;
+
+	/// \brief Locations of all write instructions, determined on first patch.
+	std::vector<InstructionPosition> write_positions;
+
+	/// \brief Byte ranges [begin, end) of the program modified by patch(), relative to the
+	///        beginning of the first instruction byte block.
+	std::vector<std::pair<std::size_t, std::size_t> > patched_byte_ranges;
+
+	/// \brief Versions of the instruction bytes of this program and the number of patched
+	///        byte ranges at each of them, in increasing order.
+	std::vector<std::pair<patch_version_type, std::size_t> > patch_versions;
+
+	/// \brief Next patch version, shared by all programs to keep versions unique.
+	static std::atomic<patch_version_type> next_patch_version;
+
+	/// \brief Part of a concatenated program stemming from one of the original programs.
+	struct Part
+	{
+		serial_number_type serial_number;
+		/// Offset of the results of the original program.
+		size_t read_offset;
+		size_t read_length;
+		/// Number of set_time() instructions preceding the part and within the part,
+		/// including the set_time(0) starting it.
+		size_t set_time_offset;
+		size_t set_time_count;
+	};
+
+	/// \see PlaybackProgram::concat()
+	std::vector<Part> parts;
+
 	std::vector<hardware_word_type> results;
 	PlaybackProgram::spikes_type spikes;
+
+	/// \brief Number of set_time() instructions executed at the time each spike was recorded.
+	std::vector<size_t> spike_set_time_counts;
+
+private:
+	void account(std::size_t const instruction_size, std::size_t const result_size)
+	{
+		instruction_bytes += instruction_size;
+		result_bytes += result_size;
+	}
+
+	/// \brief Account for the instructions emitted for a timing instruction, which are
+	///        recorded as results as well.
+	/// The encoding depends on the time, large times are emitted as several instructions.
+	/// \param size Number of bytes emitted
+	void account_timing(std::size_t const size) { account(size, size); }
+
+	/// \brief Number of bytes emitted by the builder so far.
+	/// Sizes of all but the last byte block are summed up once the next block is started.
+	std::size_t emitted_bytes()
+	{
+		auto const& blocks = bld.containers;
+		for (; completed_blocks + 1 < blocks.size(); ++completed_blocks)
+			completed_block_bytes += blocks[completed_blocks].size();
+		return completed_block_bytes + (blocks.empty() ? 0 : blocks.back().size());
+	}
+
+	std::size_t completed_blocks = 0;
+	std::size_t completed_block_bytes = 0;
 };
 
 constexpr PlaybackProgram::serial_number_type PlaybackProgram::invalid_serial_number;
@@ -51,14 +585,16 @@ PlaybackProgram::PlaybackProgram(serial_number_type serial_number)
 		throw std::logic_error("invalid serial number");
 }
 
+std::atomic<PlaybackProgram::patch_version_type> PlaybackProgram::Impl::next_patch_version{0};
+
 PlaybackProgram::PlaybackProgram(PlaybackProgram const& other)
-	: m_impl(new Impl(*other.m_impl)), m_serial_number(other.m_serial_number)
+	: m_impl(Impl::copy(*other.m_impl)), m_serial_number(other.m_serial_number)
 {}
 
 PlaybackProgram& PlaybackProgram::operator=(PlaybackProgram const& other)
 {
 	if (this != &other) {
-		m_impl.reset(new Impl(*other.m_impl));
+		m_impl = Impl::copy(*other.m_impl);
 		m_serial_number = other.m_serial_number;
 	}
 	return *this;
@@ -94,33 +630,207 @@ void PlaybackProgram::ensure_container_invariants<v2::NeuronDigitalConfig>(
 
 template <typename T>
 T PlaybackProgram::get(ContainerTicket<T> const& ticket) const
+{
+	T config;
+	get_into(ticket, config);
+	return config;
+}
+
+void PlaybackProgram::check_results(
+	serial_number_type const ticket_serial_number,
+	std::size_t const offset,
+	std::size_t const length) const
 {
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
 
-	if (ticket.serial_number != m_serial_number)
+	if (ticket_serial_number != m_serial_number)
 		throw std::invalid_argument("container ticket does not belong to this playback program");
 
-	auto const& results = m_impl->results;
-
-	if (ticket.offset >= results.size() || ticket.offset + ticket.length > results.size())
+	if (offset + length > m_impl->results.size())
 		throw std::runtime_error(
 			"container data not available yet (out of bounds of available results data)");
+}
 
-	typedef std::vector<v2::hardware_word_type> words_type;
-	words_type data{std::next(results.begin(), ticket.offset),
-					std::next(results.begin(), ticket.offset + ticket.length)};
+template <typename T>
+void PlaybackProgram::get_into(ContainerTicket<T> const& ticket, T& config) const
+{
+	check_results(ticket.serial_number, ticket.offset, ticket.length);
 
-	T config;
-	visit_preorder(config, ticket.coord, stadls::DecodeVisitor<words_type>{std::move(data)});
+	typedef stadls::Span<v2::hardware_word_type> words_type;
+	words_type const data{m_impl->results.data() + ticket.offset, ticket.length};
+
+	visit_preorder(config, ticket.coord, stadls::DecodeVisitor<words_type>{data});
 	ensure_container_invariants(config);
-	return config;
+}
+
+template <typename T>
+std::vector<T> PlaybackProgram::get(ContainerVectorTicket<T> const& ticket) const
+{
+	std::size_t const length = ticket.coords.size() * ticket.length;
+	check_results(ticket.serial_number, ticket.offset, length);
+
+	typedef stadls::Span<v2::hardware_word_type> words_type;
+	stadls::DecodeVisitor<words_type> visitor{
+		words_type{m_impl->results.data() + ticket.offset, length}};
+
+	std::vector<T> configs(ticket.coords.size());
+	auto config_it = configs.begin();
+	for (auto const& coord : ticket.coords) {
+		visit_preorder(*config_it, coord, visitor);
+		ensure_container_invariants(*config_it);
+		++config_it;
+	}
+	return configs;
+}
+
+template <typename T>
+std::vector<v2::hardware_word_type> PlaybackProgram::get_words(
+	ContainerVectorTicket<T> const& ticket) const
+{
+	std::size_t const length = ticket.coords.size() * ticket.length;
+	check_results(ticket.serial_number, ticket.offset, length);
+
+	auto const begin = std::next(m_impl->results.cbegin(), ticket.offset);
+	return {begin, std::next(begin, length)};
+}
+
+#define PLAYBACK_CONTAINER(_Name, Type)                                                            \
+	template SYMBOL_VISIBLE Type PlaybackProgram::get<Type>(ContainerTicket<Type> const&) const;   \
+	template SYMBOL_VISIBLE void PlaybackProgram::get_into<Type>(                                  \
+		ContainerTicket<Type> const&, Type&) const;                                                \
+	template SYMBOL_VISIBLE std::vector<Type> PlaybackProgram::get<Type>(                          \
+		ContainerVectorTicket<Type> const&) const;                                                 \
+	template SYMBOL_VISIBLE std::vector<v2::hardware_word_type> PlaybackProgram::get_words<Type>(   \
+		ContainerVectorTicket<Type> const&) const;
+#include "haldls/v2/container.def"
+
+PlaybackProgram PlaybackProgram::concat(std::vector<PlaybackProgram> const& programs)
+{
+	// The set_time(0) starting each program separates the spikes of the programs.
+	auto const prologue = encode_instructions([](builder_type& bld) { bld.set_time(0); });
+	auto const halt = encode_instructions([](builder_type& bld) { bld.halt(); });
+
+	PlaybackProgramBuilder builder;
+	PlaybackProgram result = builder.done();
+	auto& impl = *result.m_impl;
+
+	byte_block_type bytes;
+	for (auto const& program : programs) {
+		if (!program.m_impl)
+			throw std::logic_error("unexpected access to moved-from object");
+
+		if (program.m_serial_number == invalid_serial_number)
+			throw std::logic_error("trying to concatenate program with invalid state");
+
+		if (!program.m_impl->segments.empty())
+			throw std::invalid_argument("trying to concatenate program split into segments");
+
+		auto const& blocks = program.m_impl->bld.containers;
+		auto const positions = find_instruction_positions(blocks);
+		auto const halt_it = std::find_if(
+			positions.cbegin(), positions.cend(), [](InstructionPosition const& position) {
+				return position.kind == InstructionKind::halt;
+			});
+		if (halt_it == positions.cend())
+			throw std::invalid_argument("trying to concatenate program not terminated by halt");
+
+		bytes.insert(bytes.end(), prologue.cbegin(), prologue.cend());
+		std::size_t position = 0;
+		std::copy_n(
+			ByteStreamIterator::begin(blocks, position), halt_it->offset,
+			std::back_inserter(bytes));
+
+		std::size_t const set_time_count =
+			1 + std::count_if(
+					positions.cbegin(), halt_it, [](InstructionPosition const& position) {
+						return position.kind == InstructionKind::set_time;
+					});
+		std::size_t const set_time_offset =
+			impl.parts.empty() ? 0
+			                   : impl.parts.back().set_time_offset + impl.parts.back().set_time_count;
+		impl.parts.push_back(
+			{program.m_serial_number, impl.read_offset, program.m_impl->read_offset,
+			 set_time_offset, set_time_count});
+		impl.read_offset += program.m_impl->read_offset;
+		impl.write_count += program.m_impl->write_count;
+		impl.elapsed_time += program.m_impl->elapsed_time;
+		impl.alters_capmem = impl.alters_capmem || program.m_impl->alters_capmem;
+	}
+	bytes.insert(bytes.end(), halt.cbegin(), halt.cend());
+
+	impl.bld.containers = split_into_blocks(std::move(bytes));
+
+	return result;
+}
+
+template <typename T>
+PlaybackProgram::ContainerTicket<T> PlaybackProgram::rebase(ContainerTicket<T> const& ticket) const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	for (auto const& part : m_impl->parts) {
+		if (part.serial_number == ticket.serial_number)
+			return create_ticket<T>(ticket.coord, part.read_offset + ticket.offset, ticket.length);
+	}
+	throw std::invalid_argument(
+		"container ticket does not belong to any of the concatenated programs");
+}
+
+template <typename T>
+PlaybackProgram::ContainerVectorTicket<T> PlaybackProgram::rebase(
+	ContainerVectorTicket<T> const& ticket) const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	for (auto const& part : m_impl->parts) {
+		if (part.serial_number == ticket.serial_number)
+			return create_vector_ticket<T>(
+				ticket.coords, part.read_offset + ticket.offset, ticket.length);
+	}
+	throw std::invalid_argument(
+		"container ticket does not belong to any of the concatenated programs");
 }
 
 #define PLAYBACK_CONTAINER(_Name, Type)                                                            \
-	template SYMBOL_VISIBLE Type PlaybackProgram::get<Type>(ContainerTicket<Type> const&) const;
+	template SYMBOL_VISIBLE PlaybackProgram::ContainerTicket<Type> PlaybackProgram::rebase<Type>(  \
+		ContainerTicket<Type> const&) const;                                                       \
+	template SYMBOL_VISIBLE PlaybackProgram::ContainerVectorTicket<Type>                           \
+	PlaybackProgram::rebase<Type>(ContainerVectorTicket<Type> const&) const;
 #include "haldls/v2/container.def"
 
+PlaybackProgram::spikes_type PlaybackProgram::get_spikes(
+	serial_number_type const serial_number) const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	auto const& impl = *m_impl;
+	auto const part_it = std::find_if(
+		impl.parts.cbegin(), impl.parts.cend(), [serial_number](Impl::Part const& part) {
+			return part.serial_number == serial_number;
+		});
+	if (part_it == impl.parts.cend())
+		throw std::invalid_argument("playback program is not part of this concatenated program");
+
+	if (impl.spike_set_time_counts.size() != impl.spikes.size())
+		throw std::runtime_error("spike data not available for concatenated programs");
+
+	// Spikes recorded after the set_time(0) starting the program but before the one starting
+	// the next program
+	spikes_type spikes;
+	auto count_it = impl.spike_set_time_counts.cbegin();
+	for (auto const& spike : impl.spikes) {
+		if (*count_it > part_it->set_time_offset &&
+			*count_it <= part_it->set_time_offset + part_it->set_time_count)
+			spikes.push_back(spike);
+		++count_it;
+	}
+	return spikes;
+}
+
 PlaybackProgram::serial_number_type PlaybackProgram::serial_number() const
 {
 	return m_serial_number;
@@ -146,6 +856,117 @@ PlaybackProgram::ContainerTicket<T> PlaybackProgram::create_ticket(
 	return {m_serial_number, coord, offset, length};
 }
 
+template <typename T>
+PlaybackProgram::ContainerVectorTicket<T> PlaybackProgram::create_vector_ticket(
+	std::vector<typename T::coordinate_type> const& coords,
+	std::size_t offset,
+	std::size_t length) const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	assert(m_serial_number != invalid_serial_number);
+	return {m_serial_number, coords, offset, length};
+}
+
+template <typename T>
+PlaybackProgram::PatchTicket<T> PlaybackProgram::create_patch_ticket(
+	typename T::coordinate_type const& coord, std::size_t offset, std::size_t length) const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	assert(m_serial_number != invalid_serial_number);
+	return {m_serial_number, coord, offset, length};
+}
+
+template <typename T>
+void PlaybackProgram::patch(PatchTicket<T> const& ticket, T const& config)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	if (ticket.serial_number != m_serial_number)
+		throw std::invalid_argument("patch ticket does not belong to this playback program");
+
+	typedef std::vector<std::pair<v2::hardware_address_type, v2::hardware_word_type> >
+		data_type;
+	data_type data;
+	data.reserve(detail::ConfigSizeInWords<T>::value);
+	visit_preorder(config, ticket.coord, stadls::WriteEncodeVisitor<data_type>{data});
+
+	if (data.size() != ticket.length)
+		throw std::logic_error("number of words does not match patch slot");
+
+	auto& impl = *m_impl;
+	if (!impl.segments.empty())
+		throw std::logic_error("patching programs split into segments is not supported");
+
+	auto& blocks = impl.bld.containers;
+	if (impl.write_positions.size() != impl.write_count) {
+		impl.write_positions.clear();
+		for (auto const& position : find_instruction_positions(blocks)) {
+			if (position.kind == InstructionKind::write)
+				impl.write_positions.push_back(position);
+		}
+	}
+	if (impl.write_positions.size() != impl.write_count)
+		throw std::logic_error("unable to locate write instructions in program");
+
+	auto position_it = std::next(impl.write_positions.cbegin(), ticket.offset);
+	for (auto const& entry : data) {
+		auto const& position = *position_it;
+		auto const bytes = encode_instructions(
+			[&entry](builder_type& bld) { bld.write(entry.first, entry.second); });
+		if (bytes.size() != position.length)
+			throw std::logic_error("encoding of patched write instruction differs in size");
+
+		if (overwrite_bytes(blocks, position.offset, bytes))
+			impl.patched_byte_ranges.emplace_back(
+				position.offset, position.offset + position.length);
+		++position_it;
+	}
+	impl.add_patch_version();
+}
+
+#define PLAYBACK_CONTAINER(_Name, Type)                                                            \
+	template SYMBOL_VISIBLE void PlaybackProgram::patch<Type>(                                     \
+		PatchTicket<Type> const&, Type const&);
+#include "haldls/v2/container.def"
+
+std::vector<std::pair<std::size_t, std::size_t> > const& PlaybackProgram::patched_byte_ranges()
+	const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->patched_byte_ranges;
+}
+
+PlaybackProgram::patch_version_type PlaybackProgram::patch_version() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->patch_versions.back().first;
+}
+
+hate::optional<std::size_t> PlaybackProgram::patched_byte_range_count(
+	patch_version_type const version) const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	auto const& versions = m_impl->patch_versions;
+	auto const it = std::lower_bound(
+		versions.cbegin(), versions.cend(), version,
+		[](std::pair<patch_version_type, std::size_t> const& entry,
+		   patch_version_type const value) { return entry.first < value; });
+	if (it == versions.cend() || it->first != version)
+		return hate::nullopt;
+	return it->second;
+}
+
 std::vector<std::vector<instruction_word_type> > const& PlaybackProgram::instruction_byte_blocks()
 	const
 {
@@ -155,6 +976,41 @@ std::vector<std::vector<instruction_word_type> > const& PlaybackProgram::instruc
 	return m_impl->bld.containers;
 }
 
+std::chrono::microseconds PlaybackProgram::estimated_duration() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return std::chrono::microseconds(m_impl->elapsed_time / fpga_clock_cycles_per_us);
+}
+
+bool PlaybackProgram::alters_capmem() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->alters_capmem;
+}
+
+std::size_t PlaybackProgram::segment_count() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return std::max(m_impl->segments.size(), std::size_t(1));
+}
+
+std::vector<std::vector<instruction_word_type> > const&
+PlaybackProgram::segment_instruction_byte_blocks(std::size_t const segment) const
+{
+	if (segment >= segment_count())
+		throw std::invalid_argument("segment index out of range");
+
+	if (m_impl->segments.empty())
+		return m_impl->bld.containers;
+	return m_impl->segments[segment];
+}
+
 void PlaybackProgram::set_results(std::vector<v2::hardware_word_type>&& results)
 {
 	if (!m_impl)
@@ -177,24 +1033,43 @@ void PlaybackProgram::set_spikes(spikes_type&& spikes)
 		throw std::logic_error("unexpected access to moved-from object");
 
 	m_impl->spikes = std::move(spikes);
+	m_impl->spike_set_time_counts.clear();
+}
+
+std::size_t PlaybackProgram::read_count() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->read_offset;
+}
+
+void PlaybackProgram::set_spike_set_time_counts(std::vector<std::size_t>&& counts)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	m_impl->spike_set_time_counts = std::move(counts);
 }
 
 void PlaybackProgramBuilder::set_time(time_type t)
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.set_time(t);
+	m_program.m_impl->set_time(t);
 }
 
 void PlaybackProgramBuilder::wait_until(time_type t)
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.wait_until(t);
+	m_program.m_impl->add_safe_point(m_max_segment_size);
+	m_program.m_impl->wait_until(t);
 }
 
 void PlaybackProgramBuilder::wait_for(time_type t)
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.wait_for(t);
+	m_program.m_impl->add_safe_point(m_max_segment_size);
+	m_program.m_impl->wait_for(t);
 }
 
 void PlaybackProgramBuilder::fire(
@@ -202,7 +1077,7 @@ void PlaybackProgramBuilder::fire(
 	v2::SynapseBlock::Synapse::Address const& address)
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.fire(synapse_driver_mask.to_ulong(), address);
+	m_program.m_impl->fire(synapse_driver_mask.to_ulong(), address);
 }
 
 void PlaybackProgramBuilder::fire(
@@ -210,27 +1085,65 @@ void PlaybackProgramBuilder::fire(
 	v2::SynapseBlock::Synapse::Address const& address)
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.fire_one(synapse_driver.value(), address);
+	m_program.m_impl->fire_one(synapse_driver.value(), address);
 }
 
 void PlaybackProgramBuilder::fire_post_correlation_signal(
 	std::bitset<halco::hicann_dls::v2::NeuronOnDLS::size> const& neuron_mask)
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.write(0x1a000101, neuron_mask.to_ulong());
+	m_program.m_impl->write(0x1a000101, neuron_mask.to_ulong());
 }
 
 void PlaybackProgramBuilder::fire_post_correlation_signal(
 	halco::hicann_dls::v2::NeuronOnDLS const& neuron)
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.write(0x1a000101, 1 << neuron.value());
+	m_program.m_impl->write(0x1a000101, 1 << neuron.value());
 }
 
 void PlaybackProgramBuilder::halt()
 {
 	assert(m_program.m_impl != nullptr);
-	m_program.m_impl->bld.halt();
+	m_program.m_impl->halt();
+}
+
+void PlaybackProgramBuilder::fire_spike_train(std::vector<v2::PlaybackSpike> spikes)
+{
+	assert(m_program.m_impl != nullptr);
+
+	auto const key = [](v2::PlaybackSpike const& spike) {
+		return std::make_tuple(
+			spike.get_time(), spike.get_source_address().value(),
+			spike.get_synapse_driver().value());
+	};
+	std::sort(
+		spikes.begin(), spikes.end(),
+		[&key](v2::PlaybackSpike const& a, v2::PlaybackSpike const& b) {
+			return key(a) < key(b);
+		});
+
+	auto& impl = *m_program.m_impl;
+	auto it = spikes.cbegin();
+	while (it != spikes.cend()) {
+		auto const time = it->get_time();
+		impl.add_safe_point(m_max_segment_size);
+		impl.wait_until(time);
+		while (it != spikes.cend() && it->get_time() == time) {
+			auto const address = it->get_source_address();
+			auto const synapse_driver = it->get_synapse_driver();
+			std::bitset<halco::hicann_dls::v2::SynapseDriverOnDLS::size> synapse_driver_mask;
+			for (; it != spikes.cend() && it->get_time() == time &&
+				   it->get_source_address() == address;
+				 ++it) {
+				synapse_driver_mask.set(it->get_synapse_driver().value());
+			}
+			if (synapse_driver_mask.count() == 1)
+				impl.fire_one(synapse_driver.value(), address);
+			else
+				impl.fire(synapse_driver_mask.to_ulong(), address);
+		}
+	}
 }
 
 template <class T>
@@ -239,25 +1152,60 @@ void PlaybackProgramBuilder::write(
 {
 	assert(m_program.m_impl != nullptr);
 
-	typedef std::vector<v2::hardware_address_type> addresses_type;
-	addresses_type write_addresses;
-	visit_preorder(config, coord, stadls::WriteAddressVisitor<addresses_type>{write_addresses});
+	typedef std::vector<std::pair<v2::hardware_address_type, v2::hardware_word_type> >
+		data_type;
+	data_type data;
+	data.reserve(detail::ConfigSizeInWords<T>::value);
+	visit_preorder(config, coord, stadls::WriteEncodeVisitor<data_type>{data});
 
-	typedef std::vector<v2::hardware_word_type> words_type;
-	words_type words;
-	visit_preorder(config, coord, stadls::EncodeVisitor<words_type>{words});
+	auto& impl = *m_program.m_impl;
+	for (auto const& entry : data) {
+		impl.write(entry.first, entry.second);
+	}
+	impl.alters_capmem = impl.alters_capmem || AltersCapMem<T>::value;
+}
 
-	if (words.size() != write_addresses.size())
+template <class T>
+void PlaybackProgramBuilder::write_diff(
+	typename T::coordinate_type const& coord, T const& previous, T const& next)
+{
+	assert(m_program.m_impl != nullptr);
+
+	typedef std::vector<std::pair<v2::hardware_address_type, v2::hardware_word_type> >
+		data_type;
+	data_type previous_data;
+	previous_data.reserve(detail::ConfigSizeInWords<T>::value);
+	visit_preorder(previous, coord, stadls::WriteEncodeVisitor<data_type>{previous_data});
+	data_type next_data;
+	next_data.reserve(detail::ConfigSizeInWords<T>::value);
+	visit_preorder(next, coord, stadls::WriteEncodeVisitor<data_type>{next_data});
+
+	if (previous_data.size() != next_data.size())
 		throw std::logic_error("number of addresses and words do not match");
 
 	auto& impl = *m_program.m_impl;
-	auto addr_it = write_addresses.cbegin();
-	for (auto const& word : words) {
-		impl.bld.write(*addr_it, word);
-		++addr_it;
+	auto previous_it = previous_data.cbegin();
+	for (auto const& entry : next_data) {
+		if (entry.second != previous_it->second) {
+			impl.write(entry.first, entry.second);
+			impl.alters_capmem = impl.alters_capmem || AltersCapMem<T>::value;
+		}
+		++previous_it;
 	}
 }
 
+template <class T>
+PlaybackProgram::PatchTicket<T> PlaybackProgramBuilder::write_patchable(
+	typename T::coordinate_type const& coord, T const& config)
+{
+	assert(m_program.m_impl != nullptr);
+
+	std::size_t const offset = m_program.m_impl->write_count;
+	write(coord, config);
+	std::size_t const length = m_program.m_impl->write_count - offset;
+	return m_program.create_patch_ticket<T>(coord, offset, length);
+}
+
 template <class T>
 PlaybackProgram::ContainerTicket<T> PlaybackProgramBuilder::read(
 	typename T::coordinate_type const& coord)
@@ -273,7 +1221,7 @@ PlaybackProgram::ContainerTicket<T> PlaybackProgramBuilder::read(
 
 	auto& impl = *m_program.m_impl;
 	for (auto const& addr : read_addresses) {
-		impl.bld.read(addr);
+		impl.read(addr);
 	}
 
 	std::size_t const offset = impl.read_offset;
@@ -282,14 +1230,71 @@ PlaybackProgram::ContainerTicket<T> PlaybackProgramBuilder::read(
 	return m_program.create_ticket<T>(coord, offset, length);
 }
 
+template <class T>
+PlaybackProgram::ContainerVectorTicket<T> PlaybackProgramBuilder::read_range(
+	std::vector<typename T::coordinate_type> const& coords)
+{
+	assert(m_program.m_impl != nullptr);
+
+	typedef std::vector<v2::hardware_address_type> addresses_type;
+	addresses_type read_addresses;
+	std::size_t length = 0;
+	{
+		// Addresses only depend on the coordinate, so a single container suffices.
+		T config;
+		for (auto const& coord : coords) {
+			auto const previous_size = read_addresses.size();
+			visit_preorder(
+				config, coord, stadls::ReadAddressVisitor<addresses_type>{read_addresses});
+			if (previous_size == 0)
+				length = read_addresses.size();
+			else if (read_addresses.size() - previous_size != length)
+				throw std::logic_error("number of read addresses differs between containers");
+		}
+	}
+
+	auto& impl = *m_program.m_impl;
+	for (auto const& addr : read_addresses) {
+		impl.read(addr);
+	}
+
+	std::size_t const offset = impl.read_offset;
+	impl.read_offset += read_addresses.size();
+	return m_program.create_vector_ticket<T>(coords, offset, length);
+}
+
 PlaybackProgramBuilder::PlaybackProgramBuilder() : m_program(next_serial_number.fetch_add(1)) {}
 
+void PlaybackProgramBuilder::set_max_segment_size(std::size_t const bytes)
+{
+	m_max_segment_size = bytes;
+}
+
+std::size_t PlaybackProgramBuilder::get_max_segment_size() const
+{
+	return m_max_segment_size;
+}
+
+std::size_t PlaybackProgramBuilder::instruction_byte_size() const
+{
+	assert(m_program.m_impl != nullptr);
+	return m_program.m_impl->instruction_bytes;
+}
+
+std::size_t PlaybackProgramBuilder::result_byte_size() const
+{
+	assert(m_program.m_impl != nullptr);
+	return m_program.m_impl->result_bytes;
+}
+
 std::atomic<PlaybackProgram::serial_number_type> PlaybackProgramBuilder::next_serial_number{1};
 
 PlaybackProgram PlaybackProgramBuilder::done()
 {
 	assert(m_program.m_impl != nullptr);
 
+	m_program.m_impl->split_into_segments(m_max_segment_size);
+
 	PlaybackProgram result = std::move(m_program);
 	m_program = PlaybackProgram(next_serial_number.fetch_add(1));
 	return result;
@@ -300,10 +1305,26 @@ PlaybackProgram PlaybackProgramBuilder::done()
 		Type::coordinate_type const& coord, Type const& config);
 #include "haldls/v2/container.def"
 
+#define PLAYBACK_CONTAINER(_Name, Type)                                                            \
+	template SYMBOL_VISIBLE void PlaybackProgramBuilder::write_diff<Type>(                         \
+		Type::coordinate_type const& coord, Type const& previous, Type const& next);
+#include "haldls/v2/container.def"
+
+#define PLAYBACK_CONTAINER(_Name, Type)                                                            \
+	template SYMBOL_VISIBLE PlaybackProgram::PatchTicket<Type>                                     \
+	PlaybackProgramBuilder::write_patchable<Type>(                                                 \
+		Type::coordinate_type const& coord, Type const& config);
+#include "haldls/v2/container.def"
+
 #define PLAYBACK_CONTAINER(_Name, Type)                                                            \
 	template SYMBOL_VISIBLE PlaybackProgram::ContainerTicket<Type>                                 \
 	PlaybackProgramBuilder::read<Type>(Type::coordinate_type const& coord);
 #include "haldls/v2/container.def"
 
+#define PLAYBACK_CONTAINER(_Name, Type)                                                            \
+	template SYMBOL_VISIBLE PlaybackProgram::ContainerVectorTicket<Type>                           \
+	PlaybackProgramBuilder::read_range<Type>(std::vector<Type::coordinate_type> const& coords);
+#include "haldls/v2/container.def"
+
 } // namespace v2
 } // namespace haldls
@@ -0,0 +1,178 @@
+#include "stadls/v2/board_pool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "stadls/v2/local_board_control.h"
+
+namespace stadls {
+namespace v2 {
+
+class BoardPool::Impl
+{
+public:
+	typedef std::packaged_task<PoolExperiment(LocalBoardControl&)> task_type;
+
+	Impl(std::vector<std::string> const& usb_serial_numbers)
+	{
+		if (usb_serial_numbers.empty())
+			throw std::invalid_argument("board pool requires at least one board");
+
+		controls.reserve(usb_serial_numbers.size());
+		for (auto const& usb_serial_number : usb_serial_numbers)
+			controls.emplace_back(usb_serial_number);
+		queues.resize(controls.size());
+
+		threads.reserve(controls.size());
+		try {
+			for (std::size_t board = 0; board < controls.size(); ++board)
+				threads.emplace_back(&Impl::process_queues, this, board);
+		} catch (...) {
+			join_threads();
+			throw;
+		}
+	}
+
+	~Impl() { join_threads(); }
+
+	std::future<PoolExperiment> submit(PoolExperiment experiment)
+	{
+		task_type task([experiment = std::move(experiment)](LocalBoardControl& ctrl) mutable {
+			ctrl.run_experiment(experiment.board, experiment.chip, experiment.playback_program);
+			return std::move(experiment);
+		});
+		auto future = task.get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queues[next_queue].push_back(std::move(task));
+			next_queue = (next_queue + 1) % queues.size();
+			++pending;
+		}
+		condition.notify_all();
+		return future;
+	}
+
+	std::vector<LocalBoardControl> controls;
+
+private:
+	/// \brief Execute experiments of the board's own queue in order, steal from the back of
+	///        the longest queue of the other boards if it is empty.
+	void process_queues(std::size_t const board)
+	{
+		while (true) {
+			task_type task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this] { return stop || pending; });
+				if (!pending)
+					return;
+
+				if (!queues[board].empty()) {
+					task = std::move(queues[board].front());
+					queues[board].pop_front();
+				} else {
+					auto victim = queues.begin();
+					for (auto it = queues.begin(); it != queues.end(); ++it) {
+						if (it->size() > victim->size())
+							victim = it;
+					}
+					task = std::move(victim->back());
+					victim->pop_back();
+				}
+				--pending;
+			}
+			// Exceptions are stored in the future of the task
+			task(controls[board]);
+		}
+	}
+
+	void join_threads()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition.notify_all();
+		for (auto& thread : threads) {
+			if (thread.joinable())
+				thread.join();
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<std::deque<task_type> > queues;
+	std::size_t next_queue = 0;
+	std::size_t pending = 0;
+	bool stop = false;
+	std::vector<std::thread> threads;
+};
+
+BoardPool::BoardPool() : BoardPool(available_board_usb_serial_numbers()) {}
+
+BoardPool::BoardPool(std::vector<std::string> const& usb_serial_numbers)
+	: m_impl(new Impl(usb_serial_numbers))
+{}
+
+BoardPool::BoardPool(BoardPool&&) noexcept = default;
+
+BoardPool& BoardPool::operator=(BoardPool&&) noexcept = default;
+
+BoardPool::~BoardPool() = default;
+
+std::size_t BoardPool::size() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->controls.size();
+}
+
+std::vector<std::string> BoardPool::usb_serials() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	std::vector<std::string> result;
+	result.reserve(m_impl->controls.size());
+	for (auto const& ctrl : m_impl->controls)
+		result.push_back(ctrl.usb_serial());
+	return result;
+}
+
+std::future<PoolExperiment> BoardPool::submit(PoolExperiment experiment)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->submit(std::move(experiment));
+}
+
+std::vector<PoolExperiment> BoardPool::map(std::vector<PoolExperiment> experiments)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	std::vector<std::future<PoolExperiment> > futures;
+	futures.reserve(experiments.size());
+	for (auto& experiment : experiments)
+		futures.push_back(m_impl->submit(std::move(experiment)));
+
+	// Wait for all experiments before rethrowing the first error
+	for (auto const& future : futures)
+		future.wait();
+
+	std::vector<PoolExperiment> results;
+	results.reserve(futures.size());
+	for (auto& future : futures)
+		results.push_back(future.get());
+	return results;
+}
+
+} // namespace v2
+} // namespace stadls
@@ -0,0 +1,161 @@
+#include "stadls/v2/configuration_cache.h"
+
+#include <utility>
+
+#include "stadls/fnv1a.h"
+#include "stadls/v2/local_board_control.h"
+#include "stadls/visitors.h"
+
+namespace stadls {
+namespace v2 {
+
+namespace {
+
+std::size_t size_in_bytes(ConfigurationCache::program_bytes_type const& bytes)
+{
+	std::size_t size = 0;
+	for (auto const& block : bytes)
+		size += block.size();
+	return size;
+}
+
+std::size_t size_in_bytes(ConfigurationCache::BoardWords const& words)
+{
+	return words.addresses.size() * sizeof(haldls::v2::ocp_address_type) +
+		   words.words.size() * sizeof(haldls::v2::ocp_word_type);
+}
+
+typedef std::vector<std::pair<haldls::v2::ocp_address_type, haldls::v2::ocp_word_type> >
+	board_data_type;
+
+bool equal(ConfigurationCache::BoardWords const& words, board_data_type const& data)
+{
+	if (words.words.size() != data.size())
+		return false;
+	for (std::size_t ii = 0; ii < data.size(); ++ii) {
+		if (words.addresses[ii].value != data[ii].first.value ||
+		    words.words[ii].value != data[ii].second.value)
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+constexpr std::size_t ConfigurationCache::default_max_size_in_bytes;
+
+ConfigurationCache::ConfigurationCache()
+	: m_mutex(),
+	  m_chip_cache(default_max_size_in_bytes),
+	  m_board_cache(default_max_size_in_bytes),
+	  m_hits(0),
+	  m_misses(0)
+{}
+
+ConfigurationCache& ConfigurationCache::instance()
+{
+	static ConfigurationCache cache;
+	return cache;
+}
+
+std::shared_ptr<ConfigurationCache::program_bytes_type const>
+ConfigurationCache::get_configure_program_bytes(haldls::v2::Chip const& chip)
+{
+	std::vector<haldls::v2::hardware_word_type> words;
+	visit_preorder(
+		chip, halco::common::Unique(),
+		EncodeVisitor<std::vector<haldls::v2::hardware_word_type> >{words});
+	Fnv1a hash;
+	hash.update(words.cbegin(), words.cend());
+	auto const key = hash.value();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto const entry = m_chip_cache.find(key);
+		if (entry && entry->words == words) {
+			++m_hits;
+			return entry->bytes;
+		}
+		++m_misses;
+	}
+
+	// Encode outside of the lock, concurrent misses for the same chip just encode twice.
+	std::shared_ptr<program_bytes_type const> bytes(
+		new program_bytes_type(get_configure_program(chip, 0).instruction_byte_blocks()));
+	auto const size =
+		size_in_bytes(*bytes) + words.size() * sizeof(haldls::v2::hardware_word_type);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_chip_cache.insert(key, {std::move(words), bytes}, size);
+	return bytes;
+}
+
+std::shared_ptr<ConfigurationCache::BoardWords const> ConfigurationCache::get_board_words(
+	haldls::v2::Board const& board)
+{
+	board_data_type data;
+	data.reserve(haldls::v2::detail::ConfigSizeInWords<haldls::v2::Board>::value);
+	visit_preorder(board, halco::common::Unique(), WriteEncodeVisitor<board_data_type>{data});
+
+	Fnv1a hash;
+	for (auto const& entry : data) {
+		hash.update(entry.first.value);
+		hash.update(entry.second.value);
+	}
+	auto const key = hash.value();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto const entry = m_board_cache.find(key);
+		if (entry && equal(**entry, data)) {
+			++m_hits;
+			return *entry;
+		}
+		++m_misses;
+	}
+
+	std::shared_ptr<BoardWords> words(new BoardWords());
+	words->addresses.reserve(data.size());
+	words->words.reserve(data.size());
+	for (auto const& entry : data) {
+		words->addresses.push_back(entry.first);
+		words->words.push_back(entry.second);
+	}
+	auto const size = size_in_bytes(*words);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_board_cache.insert(key, words, size);
+	return words;
+}
+
+ConfigurationCache::Statistics ConfigurationCache::get_statistics() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return {m_hits,
+			m_misses,
+			m_chip_cache.entries() + m_board_cache.entries(),
+			m_chip_cache.size() + m_board_cache.size(),
+			m_chip_cache.max_size() + m_board_cache.max_size()};
+}
+
+void ConfigurationCache::reset_statistics()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_hits = 0;
+	m_misses = 0;
+}
+
+void ConfigurationCache::set_max_size_in_bytes(std::size_t const value)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_chip_cache.set_max_size(value);
+	m_board_cache.set_max_size(value);
+}
+
+void ConfigurationCache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_chip_cache.clear();
+	m_board_cache.clear();
+}
+
+} // namespace v2
+} // namespace stadls
@@ -1,8 +1,25 @@
 #include "stadls/v2/local_board_control.h"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <system_error>
 #include <thread>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
 
 #include "flyspi-rw_api/flyspi_com.h"
 #include "halco/common/iter_all.h"
@@ -18,6 +35,8 @@
 #include "haldls/v2/playback.h"
 #include "haldls/v2/fpga.h"
 #include "haldls/v2/spike.h"
+#include "stadls/fnv1a.h"
+#include "stadls/v2/configuration_cache.h"
 #include "stadls/v2/ocp.h"
 #include "stadls/visitors.h"
 
@@ -57,11 +76,231 @@ struct Sdram_block_write_allocator
 
 // ^^^ ------8<-----------
 
+/// \brief Bytes of results read from the SDRAM in chunks, to be decoded in-place from the
+///        USB buffers.
+/// The read of the next chunk is issued before the current chunk is handed out, chunks are
+/// released as soon as iteration proceeds past them.
+class ChunkedResultReader
+{
+public:
+	typedef uni::raw_byte_iterator<rw_api::FlyspiCom::BufferType> byte_iterator;
+
+	/// \brief Input iterator over the bytes of all chunks, all copies share the position.
+	class Iterator
+	{
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef haldls::v2::instruction_word_type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef haldls::v2::instruction_word_type const* pointer;
+		typedef haldls::v2::instruction_word_type reference;
+
+		Iterator(ChunkedResultReader& reader, bool end) : m_reader(&reader), m_end(end) {}
+
+		reference operator*() const { return *m_reader->m_it; }
+
+		Iterator& operator++()
+		{
+			m_reader->advance();
+			return *this;
+		}
+
+		void operator++(int) { ++*this; }
+
+		bool operator==(Iterator const& other) const { return at_end() == other.at_end(); }
+		bool operator!=(Iterator const& other) const { return !(*this == other); }
+
+	private:
+		bool at_end() const { return m_end || m_reader->done() || !m_reader->m_available; }
+
+		ChunkedResultReader* m_reader;
+		bool m_end;
+	};
+
+	ChunkedResultReader(
+		rw_api::FlyspiCom& com,
+		uint32_t const address,
+		std::size_t const size,
+		std::size_t const chunk_size)
+		: m_com(com), m_address(address), m_remaining(size), m_chunk_size(chunk_size)
+	{
+		request_next();
+		wait_next();
+	}
+
+	Iterator begin() { return Iterator(*this, false); }
+	Iterator end() { return Iterator(*this, true); }
+
+	/// \brief Restrict iteration to the given number of following bytes, e.g. to decode
+	///        consecutive blocks of results separately.
+	void set_available(std::size_t const bytes) { m_available = bytes; }
+
+private:
+	typedef decltype(std::declval<rw_api::flyspi::SdramBlockReadQuery&>().commit()) request_type;
+
+	struct Chunk
+	{
+		std::unique_ptr<rw_api::flyspi::SdramBlockReadQuery> query;
+		std::unique_ptr<request_type> request;
+	};
+
+	bool done() const { return !m_current.request; }
+
+	void advance()
+	{
+		++m_it;
+		--m_available;
+		if (m_it == m_end)
+			wait_next();
+	}
+
+	void request_next()
+	{
+		if (m_remaining == 0)
+			return;
+
+		std::size_t const size = std::min(m_remaining, m_chunk_size);
+		auto loc = m_com.locate().chip(0);
+		m_next.query.reset(new rw_api::flyspi::SdramBlockReadQuery(m_com, loc, size));
+		m_next.query->addr(0x08000000 + m_address);
+		m_next.request.reset(new request_type(m_next.query->commit()));
+		m_address += size;
+		m_remaining -= size;
+	}
+
+	void wait_next()
+	{
+		// Release the decoded chunk before waiting for the next one
+		m_current = std::move(m_next);
+		m_next = Chunk();
+		if (done())
+			return;
+
+		m_current.request->wait();
+		request_next();
+		m_it = byte_iterator(std::begin(*m_current.request));
+		m_end = byte_iterator(std::end(*m_current.request));
+		if (m_it == m_end)
+			wait_next();
+	}
+
+	rw_api::FlyspiCom& m_com;
+	uint32_t m_address;
+	std::size_t m_remaining;
+	std::size_t m_chunk_size;
+	std::size_t m_available = std::numeric_limits<std::size_t>::max();
+	Chunk m_current;
+	Chunk m_next;
+	byte_iterator m_it;
+	byte_iterator m_end;
+};
+
+/// \brief Re-send the specified byte ranges of an already transferred program.
+/// Ranges are extended to full SDRAM words and coalesced before transfer.
+void transfer_byte_ranges(
+	rw_api::FlyspiCom& com,
+	uint32_t const program_address,
+	std::vector<std::vector<haldls::v2::instruction_word_type> > const& program_bytes,
+	std::vector<std::pair<std::size_t, std::size_t> > byte_ranges)
+{
+	using namespace rw_api::flyspi;
+
+	static size_t const word_size = 4;
+
+	std::vector<std::pair<std::size_t, std::size_t> > word_ranges;
+	std::sort(byte_ranges.begin(), byte_ranges.end());
+	for (auto const& range : byte_ranges) {
+		std::size_t const word_begin = range.first / word_size;
+		std::size_t const word_end = (range.second + word_size - 1) / word_size;
+		if (!word_ranges.empty() && word_begin <= word_ranges.back().second)
+			word_ranges.back().second = std::max(word_ranges.back().second, word_end);
+		else
+			word_ranges.emplace_back(word_begin, word_end);
+	}
+
+	std::vector<SdramBlockWriteQuery> queries;
+	std::vector<SdramRequest> reqs;
+	queries.reserve(word_ranges.size());
+
+	auto block_it = program_bytes.cbegin();
+	std::size_t block_offset = 0;
+	for (auto const& range : word_ranges) {
+		Sdram_block_write_allocator alloc(com, program_address + range.first);
+		queries.push_back(alloc.allocate(range.second - range.first));
+
+		// Ranges may span multiple blocks, as instructions are not aligned to them.
+		auto it_out = uni::bytewise(std::begin(queries.back()));
+		for (std::size_t byte = range.first * word_size; byte < range.second * word_size;
+			 ++byte) {
+			while (byte >= block_offset + block_it->size()) {
+				block_offset += block_it->size();
+				++block_it;
+			}
+			*it_out = (*block_it)[byte - block_offset];
+			++it_out;
+		}
+
+		reqs.push_back(queries.back().commit());
+	}
+
+	for (auto& req : reqs) {
+		req.wait();
+	}
+}
+
+/// \brief Restrict the thread to run on the given CPU.
+void pin_thread(std::thread& thread, std::size_t const cpu)
+{
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	int const ret = pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpus);
+	if (ret != 0)
+		throw std::system_error(ret, std::system_category(), "unable to pin thread to CPU");
+}
+
+// Wait for the cap-mem to settle (based on empirical measurement by DS)
+// clang-format off
+haldls::v2::hardware_time_type const default_capmem_settle_time = 2'000'000; // ~ 20.8 ms for 96 MHz
+// clang-format on
+
+std::size_t const sdram_word_size = 4;
+
+/// \brief Bit offsets of consecutive bytes within an SDRAM word as laid out by uni::bytewise,
+///        which allows packing program bytes into words without iterating bytewise.
+std::array<unsigned, sdram_word_size> const& sdram_byte_shifts(rw_api::FlyspiCom& com)
+{
+	static std::array<unsigned, sdram_word_size> const shifts = [&com]() {
+		// The probe query is never committed.
+		Sdram_block_write_allocator alloc(com, 0);
+		auto probe = alloc.allocate(1);
+
+		std::array<unsigned, sdram_word_size> result;
+		for (std::size_t byte = 0; byte < sdram_word_size; ++byte) {
+			auto it_out = uni::bytewise(std::begin(probe));
+			for (std::size_t ii = 0; ii < sdram_word_size; ++ii) {
+				*it_out = (ii == byte) ? 0xff : 0;
+				++it_out;
+			}
+			auto const word = static_cast<uint32_t>(*std::begin(probe));
+			result[byte] = 0;
+			while (result[byte] < 32 && ((word >> result[byte]) & 0xff) != 0xff)
+				result[byte] += 8;
+			if (result[byte] == 32)
+				throw std::logic_error("unexpected byte layout of SDRAM words");
+		}
+		return result;
+	}();
+	return shifts;
+}
+
 struct UniDecoder
 {
 	std::vector<haldls::v2::hardware_word_type> words;
 	haldls::v2::hardware_time_type current_time = 0;
 	std::vector<haldls::v2::RecordedSpike> spikes;
+	std::size_t set_time_count = 0;
+	std::vector<std::size_t> spike_set_time_counts;
 
 	template <typename T>
 	void operator()(T const& /*inst*/)
@@ -69,7 +308,11 @@ struct UniDecoder
 
 	void operator()(uni::Write_inst const& inst) { words.push_back(inst.data); }
 
-	void operator()(uni::Set_time_inst const& inst) { current_time = inst.t; }
+	void operator()(uni::Set_time_inst const& inst)
+	{
+		current_time = inst.t;
+		++set_time_count;
+	}
 
 	void operator()(uni::Wait_until_inst const& inst) { current_time = inst.t; }
 
@@ -89,6 +332,7 @@ struct UniDecoder
 			if (!inst.fire.test(NeuronOnDLS::max - address))
 				continue;
 			spikes.emplace_back(current_time, address);
+			spike_set_time_counts.push_back(set_time_count);
 		}
 	}
 
@@ -98,7 +342,161 @@ struct UniDecoder
 		using namespace halco::hicann_dls::v2;
 		assert(inst.index < NeuronOnDLS::size);
 		spikes.emplace_back(current_time, NeuronOnDLS(NeuronOnDLS::max - inst.index));
+		spike_set_time_counts.push_back(set_time_count);
+	}
+};
+
+typedef std::vector<std::vector<haldls::v2::instruction_word_type> > program_bytes_type;
+
+/// \brief Size of the program in SDRAM words.
+std::size_t size_in_words(program_bytes_type const& program_bytes)
+{
+	std::size_t size = 0;
+	for (auto const& block : program_bytes)
+		size += block.size() / sdram_word_size;
+	return size;
+}
+
+/// \brief FNV-1a hash over the program bytes.
+std::size_t content_hash(program_bytes_type const& program_bytes)
+{
+	stadls::Fnv1a hash;
+	for (auto const& block : program_bytes)
+		hash.update(block.cbegin(), block.cend());
+	return static_cast<std::size_t>(hash.value());
+}
+
+/// \brief Program kept resident in the SDRAM.
+struct ResidentProgram
+{
+	/// Location of the program in SDRAM words.
+	uint32_t address = 0;
+	uint32_t size = 0;
+	/// Patch version of a playback program present in the SDRAM, to distinguish copies of a
+	/// program sharing the same serial number.
+	haldls::v2::PlaybackProgram::patch_version_type patch_version = 0;
+	/// Copy of raw program bytes, to rule out content hash collisions.
+	program_bytes_type bytes;
+};
+
+/// \brief Programs kept resident in the SDRAM, switching to one of them only requires
+///        selecting its location.
+/// Playback programs are identified by their serial number, raw program bytes by their
+/// content hash. Space is allocated first-fit, least recently used programs are evicted
+/// until a sufficiently large gap is available.
+/// \note stadls::LRUCache is not used, as its size-based eviction does not account for the
+///       fragmentation of the address space.
+class ResidentPrograms
+{
+public:
+	enum class KeyKind
+	{
+		serial_number,
+		content_hash
+	};
+	typedef std::pair<KeyKind, std::size_t> key_type;
+
+	explicit ResidentPrograms(uint32_t const capacity) : m_capacity(capacity) {}
+
+	/// \brief Look up the program for the given key and mark it as most recently used.
+	/// Entries not satisfying the given predicate are erased.
+	/// \return Pointer to the resident program or nullptr if there is no valid entry.
+	template <typename PredicateT>
+	ResidentProgram* find(key_type const& key, PredicateT const& valid)
+	{
+		auto const it = m_index.find(key);
+		if (it == m_index.end() || !valid(it->second->second)) {
+			if (it != m_index.end())
+				erase(it);
+			++m_statistics.misses;
+			return nullptr;
+		}
+		++m_statistics.hits;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return &it->second->second;
+	}
+
+	/// \brief Allocate space for a program of the given size in SDRAM words, evicting least
+	///        recently used programs as necessary.
+	ResidentProgram& insert(key_type const& key, uint32_t const size)
+	{
+		if (size > m_capacity)
+			throw std::logic_error(
+				"program size(" + std::to_string(size) + ") exceeds FPGA memory(" +
+				std::to_string(m_capacity) + ")");
+
+		auto const existing = m_index.find(key);
+		if (existing != m_index.end())
+			erase(existing);
+
+		hate::optional<uint32_t> address;
+		while (!(address = find_gap(size))) {
+			erase(m_index.find(m_entries.back().first));
+			++m_statistics.evictions;
+		}
+
+		m_entries.emplace_front(key, ResidentProgram());
+		auto& program = m_entries.front().second;
+		program.address = *address;
+		program.size = size;
+		m_index.emplace(key, m_entries.begin());
+		m_addresses.emplace(*address, m_entries.begin());
+		m_size += size;
+		return program;
+	}
+
+	void clear()
+	{
+		m_entries.clear();
+		m_index.clear();
+		m_addresses.clear();
+		m_size = 0;
+	}
+
+	stadls::v2::ResidentProgramStatistics get_statistics() const
+	{
+		auto statistics = m_statistics;
+		statistics.entries = m_entries.size();
+		statistics.size = m_size;
+		return statistics;
+	}
+
+	void reset_statistics() { m_statistics = stadls::v2::ResidentProgramStatistics(); }
+
+private:
+	typedef std::list<std::pair<key_type, ResidentProgram> > entries_type;
+	typedef std::map<key_type, entries_type::iterator> index_type;
+
+	/// \brief Lowest address with the given number of free words following it.
+	hate::optional<uint32_t> find_gap(uint32_t const size) const
+	{
+		uint32_t begin = 0;
+		for (auto const& entry : m_addresses) {
+			if (entry.first - begin >= size)
+				return begin;
+			begin = entry.first + entry.second->second.size;
+		}
+		if (m_capacity - begin >= size)
+			return begin;
+		return hate::nullopt;
+	}
+
+	void erase(index_type::iterator const it)
+	{
+		auto const& program = it->second->second;
+		m_size -= program.size;
+		m_addresses.erase(program.address);
+		m_entries.erase(it->second);
+		m_index.erase(it);
 	}
+
+	uint32_t m_capacity;
+	std::size_t m_size = 0;
+	/// Most recently used first.
+	entries_type m_entries;
+	index_type m_index;
+	std::map<uint32_t, entries_type::iterator> m_addresses;
+	stadls::v2::ResidentProgramStatistics m_statistics;
 };
 
 } // namespace
@@ -111,29 +509,534 @@ class LocalBoardControl::Impl
 public:
 	typedef haldls::v2::hardware_word_type hardware_word_type;
 	typedef haldls::v2::hardware_address_type hardware_address_type;
+	typedef std::vector<std::vector<haldls::v2::instruction_word_type> > program_bytes_type;
+
+	/// \brief Status registers of a finished execution.
+	struct Status
+	{
+		haldls::v2::FlyspiResultSize result_size;
+		haldls::v2::FlyspiException exception;
+	};
+
+	Impl(std::string const& usb_serial_number)
+		: com(usb_serial_number), resident_programs(rw_api::FlyspiCom::SdramChannel::max_size)
+	{}
+
+	~Impl() { join_io_thread(); }
 
-	Impl(std::string const& usb_serial_number) : com(usb_serial_number) {}
+	/// \brief Enqueue the task for execution on the I/O thread of the board, which is
+	///        started on first use.
+	std::future<void> submit(std::function<void()> task)
+	{
+		std::packaged_task<void()> packaged_task(std::move(task));
+		auto future = packaged_task.get_future();
+		{
+			std::lock_guard<std::mutex> lock(io_mutex);
+			if (!io_thread.joinable()) {
+				stop_io_thread = false;
+				io_thread = std::thread(&Impl::process_io_queue, this);
+				if (spin_polling && spin_polling->cpu)
+					pin_thread(io_thread, *spin_polling->cpu);
+			}
+			io_queue.push_back(std::move(packaged_task));
+		}
+		io_condition.notify_one();
+		return future;
+	}
+
+	/// \brief Enqueue the run for execution on the I/O thread, it is pending until finished.
+	std::future<void> submit_run(std::function<void()> run)
+	{
+		{
+			std::lock_guard<std::mutex> lock(io_mutex);
+			++pending_runs;
+		}
+		auto const finish = [this]() {
+			std::lock_guard<std::mutex> lock(io_mutex);
+			--pending_runs;
+		};
+		try {
+			return submit([run, finish]() {
+				try {
+					run();
+				} catch (...) {
+					finish();
+					throw;
+				}
+				finish();
+			});
+		} catch (...) {
+			finish();
+			throw;
+		}
+	}
+
+	/// \brief Throw if asynchronous runs are pending, unless called by the I/O thread
+	///        executing them.
+	void check_no_pending_runs() const
+	{
+		if (std::this_thread::get_id() == io_thread.get_id())
+			return;
+		std::lock_guard<std::mutex> lock(io_mutex);
+		if (pending_runs)
+			throw std::logic_error(
+				"board accessed while " + std::to_string(pending_runs) +
+				" asynchronous runs are pending");
+	}
+
+	void set_spin_polling(hate::optional<SpinPolling> const& value)
+	{
+		std::lock_guard<std::mutex> lock(io_mutex);
+		spin_polling = value;
+		if (io_thread.joinable() && spin_polling && spin_polling->cpu)
+			pin_thread(io_thread, *spin_polling->cpu);
+	}
+
+	/// \brief Process all enqueued tasks and stop the I/O thread.
+	void join_io_thread()
+	{
+		{
+			std::lock_guard<std::mutex> lock(io_mutex);
+			stop_io_thread = true;
+		}
+		io_condition.notify_one();
+		if (io_thread.joinable())
+			io_thread.join();
+	}
+
+	/// \brief Write the program to the SDRAM starting at the given address.
+	/// \return Size of the program in SDRAM words
+	hardware_address_type upload_program(
+		hardware_address_type const address, program_bytes_type const& program_bytes)
+	{
+		// vvv ------8<----------- (legacy code copied from frickel-dls)
+
+		using namespace rw_api::flyspi;
+
+		std::vector<SdramBlockWriteQuery> queries;
+		std::vector<SdramRequest> reqs;
+		queries.reserve(program_bytes.size());
+		reqs.reserve(program_bytes.size());
+		Sdram_block_write_allocator alloc(com, address);
+
+		auto const& shifts = sdram_byte_shifts(com);
+
+		// copy to USB buffer memory word by word and transfer each block right away
+		for (auto const& container : program_bytes) {
+			std::size_t const size = container.size() / sdram_word_size;
+			queries.push_back(alloc.allocate(size));
+
+			auto it_in = std::begin(container);
+			auto it_out = std::begin(queries.back());
+			for (std::size_t word = 0; word < size; ++word) {
+				rw_api::FlyspiCom::Data data = 0;
+				for (auto const shift : shifts) {
+					data |= static_cast<rw_api::FlyspiCom::Data>(*it_in) << shift;
+					++it_in;
+				}
+				*it_out = data;
+				++it_out;
+			}
+
+			reqs.push_back(queries.back().commit());
+		}
+
+		// wait for completion of transfer
+		for (auto& req : reqs) {
+			req.wait();
+		}
+
+		// ^^^ ------8<-----------
+
+		return alloc.address - address;
+	}
+
+	/// \brief Write the board configuration words, skipping words unchanged since the last
+	///        write of a configuration with the same addresses.
+	void write_board(
+		std::vector<haldls::v2::ocp_address_type> const& addresses,
+		std::vector<haldls::v2::ocp_word_type> const& words)
+	{
+		if (addresses.size() != words.size())
+			throw std::invalid_argument("number of board addresses and words differ");
+
+		bool const shadowed = board_shadow && std::equal(
+			addresses.cbegin(), addresses.cend(), board_shadow->addresses.cbegin(),
+			board_shadow->addresses.cend(),
+			[](haldls::v2::ocp_address_type const& a, haldls::v2::ocp_address_type const& b) {
+				return a.value == b.value;
+			});
+
+		std::vector<haldls::v2::ocp_address_type> changed_addresses;
+		std::vector<haldls::v2::ocp_word_type> changed_words;
+		for (std::size_t ii = 0; ii < words.size(); ++ii) {
+			if (!shadowed || words[ii].value != board_shadow->words[ii].value) {
+				changed_addresses.push_back(addresses[ii]);
+				changed_words.push_back(words[ii]);
+			}
+		}
+		if (changed_words.empty())
+			return;
+
+		// The board state is unknown if the write fails
+		board_shadow.reset();
+		flyspi_config_shadow.reset();
+		ocp_write(com, changed_words, changed_addresses);
+		board_shadow = ConfigurationCache::BoardWords{addresses, words};
+
+		// Track the FPGA configuration if it is part of the written words
+		halco::common::Unique unique;
+		auto const config_address =
+			haldls::v2::FlyspiConfig().addresses(unique).front().value;
+		for (std::size_t ii = 0; ii < addresses.size(); ++ii) {
+			if (addresses[ii].value == config_address) {
+				haldls::v2::FlyspiConfig config;
+				config.decode({{words[ii]}});
+				flyspi_config_shadow = config;
+			}
+		}
+	}
+
+	/// \brief Forget all state of the board assumed to be known from previous operations.
+	void invalidate()
+	{
+		program_serial_number = haldls::v2::PlaybackProgram::invalid_serial_number;
+		resident_programs.clear();
+		board_shadow.reset();
+		flyspi_config_shadow.reset();
+		capmem_shadow.reset();
+		last_status.reset();
+	}
+
+	/// \brief Select the location of the results of the next execution of the selected program.
+	void select_result_address(hardware_address_type const new_result_address)
+	{
+		result_address = new_result_address;
+		halco::common::Unique unique;
+		ocp_write_container(com, unique, haldls::v2::FlyspiResultAddress(result_address));
+	}
+
+	/// \brief Select the program to be executed next and the location of its results.
+	void select_program(
+		hardware_address_type const new_program_address,
+		hardware_address_type const new_program_size,
+		hardware_address_type const new_result_address)
+	{
+		program_address = new_program_address;
+		program_size = new_program_size;
+		result_address = new_result_address;
+
+		// write program address, size and result pointer
+		halco::common::Unique unique;
+		ocp_write_container(com, unique, haldls::v2::FlyspiProgramAddress(program_address));
+		ocp_write_container(com, unique, haldls::v2::FlyspiProgramSize(program_size));
+		ocp_write_container(com, unique, haldls::v2::FlyspiResultAddress(result_address));
+	}
+
+	/// \brief Set the execute flag, without waiting for it to be cleared.
+	void start_execution()
+	{
+		auto log = log4cxx::Logger::getLogger("LocalBoardControl::execute");
+		halco::common::Unique unique;
+
+		// check that the DLS is not in reset, the configuration is only read if not known from
+		// previous writes
+		if (!flyspi_config_shadow)
+			flyspi_config_shadow = ocp_read_container<haldls::v2::FlyspiConfig>(com, unique);
+		if (flyspi_config_shadow->get_dls_reset()) {
+			LOG4CXX_ERROR(log, "Asking to execute a program although the DLS is in reset.");
+			LOG4CXX_ERROR(log, "This is prohibited for v2 as it will freeze the system.");
+			throw haldls::exception::InvalidConfiguration(
+				"Refuse to execute playback program with DLSv2 in reset");
+		}
+
+		// start execution by setting the execute bit
+		haldls::v2::FlyspiControl control;
+		control.set_execute(true);
+		LOG4CXX_DEBUG(log, "start execution");
+		ocp_write_container(com, unique, control);
+		execution_start = std::chrono::steady_clock::now();
+		last_status.reset();
+	}
+
+	/// \brief Wait until the execute flag is cleared.
+	/// \see LocalBoardControl::execute()
+	void wait_for_execution(
+		std::chrono::microseconds const min_wait_period = default_min_wait_period,
+		std::chrono::microseconds const max_wait_period = default_max_wait_period,
+		std::chrono::microseconds const max_wait = default_max_wait,
+		hate::optional<std::chrono::microseconds> const expected_runtime = hate::nullopt)
+	{
+		// Poll on the pinned I/O thread, the calling thread only waits for the result
+		if (spin_polling && spin_polling->cpu && std::this_thread::get_id() != io_thread.get_id()) {
+			submit([=]() {
+				wait_for_execution(min_wait_period, max_wait_period, max_wait, expected_runtime);
+			}).get();
+			return;
+		}
+
+		auto log = log4cxx::Logger::getLogger("LocalBoardControl::execute");
+		halco::common::Unique unique;
+
+		if (expected_runtime) {
+			std::this_thread::sleep_for(*expected_runtime);
+		}
+		// polls only read the control register, result size and exception state are read once
+		// afterwards
+		ExecutionStatistics statistics;
+		auto const poll = [&]() {
+			++statistics.polls;
+			return ocp_read_container<haldls::v2::FlyspiControl>(com, unique).get_execute();
+		};
+		bool executing = true;
+		if (spin_polling) {
+			auto const spin_end = std::chrono::steady_clock::now() + spin_polling->spin_budget;
+			do {
+				executing = poll();
+			} while (executing && std::chrono::steady_clock::now() < spin_end);
+			statistics.spun = !executing;
+		}
+		std::chrono::microseconds waited(0);
+		std::chrono::microseconds wait_period(min_wait_period);
+		while (executing) {
+			LOG4CXX_DEBUG(
+			    log, "execute flag not yet cleared, sleep for " << wait_period.count() << "us");
+			std::this_thread::sleep_for(wait_period);
+			executing = poll();
+
+			if (waited.count() > max_wait.count()) {
+				LOG4CXX_ERROR(
+				    log, "execute flag not cleared for " << max_wait.count() << "us, aborting!");
+				board_shadow.reset();
+				flyspi_config_shadow.reset();
+				capmem_shadow.reset();
+				auto exception = ocp_read_container<haldls::v2::FlyspiException>(com, unique);
+				LOG4CXX_ERROR(log, exception)
+				break;
+			}
+			// Exponentially increase sleep time until max. specified
+			if (wait_period.count() < max_wait_period.count()) {
+				wait_period *= 2;
+				if (wait_period.count() > max_wait_period.count()) {
+					wait_period = max_wait_period;
+				}
+			}
+			waited += wait_period;
+		}
+		statistics.completion_latency = std::chrono::steady_clock::now() - execution_start;
+		last_execution_statistics = statistics;
+		if (!executing) {
+			last_status = read_status();
+		}
+		LOG4CXX_DEBUG(log, "execution finished");
+	}
+
+	/// \brief Wait for the execution of a program with the given estimated duration,
+	///        sleeping until shortly before its estimated completion and polling finely
+	///        afterwards.
+	void wait_for_estimated_execution(std::chrono::microseconds const estimate)
+	{
+		if (estimate > execute_guard_period) {
+			wait_for_execution(
+				default_min_wait_period, fine_max_wait_period,
+				std::max(default_max_wait, 2 * estimate), estimate - execute_guard_period);
+		} else {
+			wait_for_execution();
+		}
+	}
+
+	/// \brief Read result size and exception state, the only status registers needed after
+	///        an execution.
+	Status read_status()
+	{
+		halco::common::Unique unique;
+		return {ocp_read_container<haldls::v2::FlyspiResultSize>(com, unique),
+		        ocp_read_container<haldls::v2::FlyspiException>(com, unique)};
+	}
+
+	/// \brief Size of the results of the last execution in SDRAM words.
+	/// Throws if the FPGA raised an exception during execution.
+	std::size_t result_size()
+	{
+		auto log = log4cxx::Logger::getLogger("LocalBoardControl::fetch");
+
+		// get result size and exception state, reuse the status read at the end of the
+		// execution if available
+		if (!last_status) {
+			last_status = read_status();
+		}
+
+		auto const& result_size = last_status->result_size;
+		if (!result_size.get_value()) {
+			throw std::logic_error("no result size read from board");
+		}
+		if (result_size.get_value().value() > rw_api::FlyspiCom::SdramChannel::max_size) {
+			throw std::logic_error(
+				"to be read back data(" + std::to_string(result_size.get_value().value()) +
+				") exceeds FPGA memory(" +
+				std::to_string(rw_api::FlyspiCom::SdramChannel::max_size) + ")");
+		}
+		auto const& exception = last_status->exception;
+		if (!exception.check().value()) {
+			LOG4CXX_ERROR(log, "FPGA exception raised: " << exception);
+			board_shadow.reset();
+			flyspi_config_shadow.reset();
+			capmem_shadow.reset();
+			throw std::logic_error("FPGA exception raised, aborting fetching");
+		}
+		return result_size.get_value().value();
+	}
+
+	/// \brief Decode the given number of result words starting at the given address in chunks
+	///        directly from the USB buffers.
+	template <typename DecoderT>
+	void decode_results(
+		hardware_address_type const address, std::size_t const size, DecoderT& decoder)
+	{
+		ChunkedResultReader reader(com, address, size, result_chunk_size);
+		uni::decode(reader.begin(), reader.end(), decoder);
+	}
+
+	/// \brief Read the given number of result words starting at the given address.
+	std::vector<haldls::v2::instruction_word_type> read_results(
+		hardware_address_type const address, std::size_t const size)
+	{
+		// vvv ------8<----------- (legacy code copied from frickel-dls)
+
+		using namespace rw_api::flyspi;
+
+		// transfer data back
+		auto loc = com.locate().chip(0);
+		SdramBlockReadQuery q_read(com, loc, size);
+		q_read.addr(0x08000000 + address);
+
+		auto r_read = q_read.commit();
+		r_read.wait();
+
+		// ^^^ ------8<-----------
+
+		// extract read/write results from data
+
+		std::vector<haldls::v2::instruction_word_type> bytes;
+		std::copy(
+			uni::raw_byte_iterator<rw_api::FlyspiCom::BufferType>(std::begin(r_read)),
+			uni::raw_byte_iterator<rw_api::FlyspiCom::BufferType>(std::end(r_read)),
+			std::back_inserter(bytes));
+		return bytes;
+	}
+
+	/// \brief Number of SDRAM words read at once when decoding results.
+	static constexpr std::size_t result_chunk_size = 1 << 18;
+
+	// legacy value
+	static constexpr std::chrono::microseconds default_min_wait_period{50};
+	// 10ms max. period time for fine enough resolution in short sweeps
+	static constexpr std::chrono::microseconds default_max_wait_period{10000};
+	// typical experiments don't last longer than 60s (PSP: 19.11.2018, OJB: 23.05.2018)
+	static constexpr std::chrono::microseconds default_max_wait{60 * 1000 * 1000};
+	// max. period time after sleeping for the estimated runtime of a program
+	static constexpr std::chrono::microseconds fine_max_wait_period{1000};
+	// time before the estimated completion of a program to start polling
+	static constexpr std::chrono::microseconds execute_guard_period{100};
 
 	rw_api::FlyspiCom com;
 
+	/// Serial number of the selected playback program, invalid for raw program bytes.
 	haldls::v2::PlaybackProgram::serial_number_type program_serial_number =
 		haldls::v2::PlaybackProgram::invalid_serial_number;
-	static constexpr hardware_address_type program_address = 0;
+	/// \see LocalBoardControl::get_resident_program_statistics()
+	ResidentPrograms resident_programs;
+	/// Location of the selected program and its results, in SDRAM words.
+	hardware_address_type program_address = 0;
 	hardware_address_type program_size = 0;
-	static constexpr hardware_address_type result_address = 0;
+	hardware_address_type result_address = 0;
+
+	/// \brief Board configuration words last written, unknown if not set.
+	hate::optional<ConfigurationCache::BoardWords> board_shadow;
+	/// \brief FPGA configuration last written, unknown if not set.
+	hate::optional<haldls::v2::FlyspiConfig> flyspi_config_shadow;
+
+	/// \brief CapMem-related words of the chip configuration last applied, unknown if not set.
+	/// \see get_capmem_words()
+	hate::optional<std::vector<haldls::v2::hardware_word_type> > capmem_shadow;
+	/// \see LocalBoardControl::set_capmem_settle_duration()
+	std::chrono::microseconds capmem_settle_duration{
+		default_capmem_settle_time / haldls::v2::fpga_clock_cycles_per_us};
+
+	/// \see LocalBoardControl::set_spin_polling()
+	hate::optional<SpinPolling> spin_polling;
+	std::chrono::steady_clock::time_point execution_start;
+	ExecutionStatistics last_execution_statistics;
+	/// \brief Registers read after the execute flag was cleared by the last execution.
+	hate::optional<Status> last_status;
+
+private:
+	void process_io_queue()
+	{
+		while (true) {
+			std::packaged_task<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(io_mutex);
+				io_condition.wait(lock, [this] { return stop_io_thread || !io_queue.empty(); });
+				if (io_queue.empty())
+					return;
+				task = std::move(io_queue.front());
+				io_queue.pop_front();
+			}
+			// Exceptions are stored in the future of the task
+			task();
+		}
+	}
+
+	mutable std::mutex io_mutex;
+	std::condition_variable io_condition;
+	std::deque<std::packaged_task<void()> > io_queue;
+	bool stop_io_thread = false;
+	std::thread io_thread;
+	/// \brief Number of submitted asynchronous runs not yet finished.
+	std::size_t pending_runs = 0;
 };
 
+constexpr std::size_t LocalBoardControl::Impl::result_chunk_size;
+constexpr std::chrono::microseconds LocalBoardControl::Impl::default_min_wait_period;
+constexpr std::chrono::microseconds LocalBoardControl::Impl::default_max_wait_period;
+constexpr std::chrono::microseconds LocalBoardControl::Impl::default_max_wait;
+constexpr std::chrono::microseconds LocalBoardControl::Impl::fine_max_wait_period;
+constexpr std::chrono::microseconds LocalBoardControl::Impl::execute_guard_period;
+
 LocalBoardControl::LocalBoardControl(std::string const& usb_serial_number)
 	: m_impl(new Impl(usb_serial_number))
 {
 	soft_reset();
 }
 
-LocalBoardControl::LocalBoardControl(LocalBoardControl&&) noexcept = default;
+LocalBoardControl::LocalBoardControl(LocalBoardControl&& other) noexcept
+{
+	// Pending tasks refer to the other object, finish them before it is moved from
+	if (other.m_impl)
+		other.m_impl->join_io_thread();
+	m_impl = std::move(other.m_impl);
+}
 
-LocalBoardControl& LocalBoardControl::operator=(LocalBoardControl&&) noexcept = default;
+LocalBoardControl& LocalBoardControl::operator=(LocalBoardControl&& other) noexcept
+{
+	if (this != &other) {
+		// Pending tasks refer to either object, finish them while both are still valid
+		if (m_impl)
+			m_impl->join_io_thread();
+		if (other.m_impl)
+			other.m_impl->join_io_thread();
+		m_impl = std::move(other.m_impl);
+	}
+	return *this;
+}
 
-LocalBoardControl::~LocalBoardControl() = default;
+LocalBoardControl::~LocalBoardControl()
+{
+	// Pending tasks refer to this object, finish them while it is still valid
+	if (m_impl)
+		m_impl->join_io_thread();
+}
 
 std::string LocalBoardControl::usb_serial() const
 {
@@ -144,9 +1047,14 @@ void LocalBoardControl::soft_reset()
 {
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
 
 	halco::common::Unique unique;
 
+	// Do not rely on the previously transferred programs, board and chip configuration to be
+	// retained
+	m_impl->invalidate();
+
 	// Set dls and soft reset
 	haldls::v2::FlyspiConfig reset_config;
 	reset_config.set_dls_reset(true);
@@ -154,22 +1062,44 @@ void LocalBoardControl::soft_reset()
 	ocp_write_container(m_impl->com, unique, reset_config);
 
 	// Set default config
-	ocp_write_container(m_impl->com, unique, haldls::v2::FlyspiConfig());
+	haldls::v2::FlyspiConfig const default_config;
+	ocp_write_container(m_impl->com, unique, default_config);
+	m_impl->flyspi_config_shadow = default_config;
 }
 
 void LocalBoardControl::configure_static(
 	std::vector<haldls::v2::ocp_address_type> const& board_addresses,
 	std::vector<haldls::v2::ocp_word_type> const& board_words,
-	std::vector<std::vector<haldls::v2::instruction_word_type> > const& chip_program_bytes)
+	std::vector<std::vector<haldls::v2::instruction_word_type> > const& chip_program_bytes,
+	std::vector<haldls::v2::hardware_word_type> const& chip_capmem_words)
 {
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
 
 	// Write the board config
-	ocp_write(m_impl->com, board_words, board_addresses);
+	m_impl->write_board(board_addresses, board_words);
 
+	bool const settle = !m_impl->capmem_shadow || *m_impl->capmem_shadow != chip_capmem_words;
+	// The analog state is unknown if the configuration fails
+	m_impl->capmem_shadow.reset();
 	transfer(chip_program_bytes);
 	execute();
+	if (settle)
+		std::this_thread::sleep_for(m_impl->capmem_settle_duration);
+	m_impl->capmem_shadow = chip_capmem_words;
+}
+
+void LocalBoardControl::configure_static(
+	std::vector<haldls::v2::ocp_address_type> const& board_addresses,
+	std::vector<haldls::v2::ocp_word_type> const& board_words,
+	std::vector<std::vector<haldls::v2::instruction_word_type> > const& chip_program_bytes)
+{
+	// The applied CapMem-related configuration is unknown, so the shadow can neither be
+	// matched nor updated
+	invalidate_capmem_shadow();
+	configure_static(board_addresses, board_words, chip_program_bytes, {});
+	invalidate_capmem_shadow();
 }
 
 void LocalBoardControl::configure_static(
@@ -177,95 +1107,101 @@ void LocalBoardControl::configure_static(
 {
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
 
 	// An experiment always happens as follows:
 	// * Set the board config, including DACs, spike router and FPGA config
-	// * Set the chip config and wait for the cap-mem to settle
+	// * Set the chip config and wait for the cap-mem to settle if its config changed
 
-	halco::common::Unique const coord;
+	auto& cache = ConfigurationCache::instance();
 
 	// Set the board
-	ocp_write_container(m_impl->com, coord, board);
+	auto const board_words = cache.get_board_words(board);
+	m_impl->write_board(board_words->addresses, board_words->words);
 
 	// If the dls is in reset during playback of a playback program, the FPGA
 	// will never stop execution for v2 and freeze the FPGA. Therefore, the
 	// playback of programs is prohibited if the DLS is in reset.
-	// TODO: Move this check to LocalBoardControl::execute()?? This adds
-	// additional overhead in the execution of experiments
+	// Execution is refused with the DLS in reset, see LocalBoardControl::execute(), so the
+	// chip configuration is skipped here.
 	if (board.get_flyspi_config().get_dls_reset()) {
 		auto log = log4cxx::Logger::getLogger(__func__);
 		LOG4CXX_WARN(log, "DLS in reset during configuration");
 		LOG4CXX_WARN(log, "The chip configuration cannot be written");
+		m_impl->capmem_shadow.reset();
 	} else {
-		auto setup = get_configure_program(chip);
-
-		run(setup);
+		auto const capmem_words = get_capmem_words(board, chip);
+		bool const settle = !m_impl->capmem_shadow || *m_impl->capmem_shadow != capmem_words;
+		// The analog state is unknown if the configuration fails
+		m_impl->capmem_shadow.reset();
+		run(*cache.get_configure_program_bytes(chip));
+		if (settle)
+			std::this_thread::sleep_for(m_impl->capmem_settle_duration);
+		m_impl->capmem_shadow = capmem_words;
 	}
 }
 
-haldls::v2::PlaybackProgram get_configure_program(haldls::v2::Chip chip)
+haldls::v2::PlaybackProgram get_configure_program(haldls::v2::Chip const& chip)
+{
+	return get_configure_program(chip, default_capmem_settle_time);
+}
+
+haldls::v2::PlaybackProgram get_configure_program(
+	haldls::v2::Chip const& chip, haldls::v2::hardware_time_type const capmem_settle_time)
 {
 	// Chip configuration program
 	haldls::v2::PlaybackProgramBuilder setup_builder;
 	setup_builder.set_time(0);
 	setup_builder.write(halco::common::Unique(), chip);
-	// Wait for the cap-mem to settle (based on empirical measurement by DS)
-	// clang-format off
-	setup_builder.wait_for(2'000'000); // ~ 20.8 ms for 96 MHz
-	// clang-format on
+	if (capmem_settle_time)
+		setup_builder.wait_for(capmem_settle_time);
 	setup_builder.halt();
 	return setup_builder.done();
 }
 
+std::vector<haldls::v2::hardware_word_type> get_capmem_words(
+	haldls::v2::Board const& board, haldls::v2::Chip const& chip)
+{
+	typedef std::vector<haldls::v2::hardware_word_type> words_type;
+	words_type words;
+	auto const capmem = chip.get_capmem();
+	visit_preorder(capmem, halco::hicann_dls::v2::CapMemOnDLS(), EncodeVisitor<words_type>{words});
+	auto const capmem_config = chip.get_capmem_config();
+	visit_preorder(
+		capmem_config, halco::hicann_dls::v2::CapMemConfigOnDLS(),
+		EncodeVisitor<words_type>{words});
+	for (auto const parameter :
+	     {haldls::v2::Board::Parameter::capmem_i_buf_bias,
+	      haldls::v2::Board::Parameter::capmem_i_offset,
+	      haldls::v2::Board::Parameter::capmem_i_ref}) {
+		words.push_back(board.get_parameter(parameter).value());
+	}
+	return words;
+}
+
 
 void LocalBoardControl::transfer(
 	std::vector<std::vector<haldls::v2::instruction_word_type> > const& program_bytes)
 {
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
-
-	// vvv ------8<----------- (legacy code copied from frickel-dls)
-
-	using namespace rw_api::flyspi;
-
-	std::vector<SdramBlockWriteQuery> queries;
-	std::vector<SdramRequest> reqs;
-	Sdram_block_write_allocator alloc(m_impl->com, m_impl->program_address);
-
-	// copy to USB buffer memory and transfer
-	for (auto const& container : program_bytes) {
-		queries.push_back(alloc.allocate(container.size() / 4));
-
-		auto it_in = std::begin(container);
-		auto it_out = uni::bytewise(std::begin(queries.back()));
-		while (it_in != std::end(container)) {
-			*it_out = *it_in;
-			++it_in;
-			++it_out;
-		}
-
-		reqs.push_back(queries.back().commit());
-	}
-
-	// wait for completion of transfer
-	for (auto& req : reqs) {
-		req.wait();
+	m_impl->check_no_pending_runs();
+
+	ResidentPrograms::key_type const key(
+		ResidentPrograms::KeyKind::content_hash, content_hash(program_bytes));
+	auto* program = m_impl->resident_programs.find(
+		key, [&program_bytes](ResidentProgram const& resident) {
+			return resident.bytes == program_bytes;
+		});
+	if (!program) {
+		program = &m_impl->resident_programs.insert(key, size_in_words(program_bytes));
+		program->size = m_impl->upload_program(program->address, program_bytes);
+		program->bytes = program_bytes;
 	}
+	m_impl->select_program(program->address, program->size, 0);
 
-	// ^^^ ------8<-----------
-
-	m_impl->program_size = alloc.address - m_impl->program_address;
-
-	// write program address, size and result pointer
-	haldls::v2::FlyspiProgramAddress program_address(m_impl->program_address);
-	haldls::v2::FlyspiProgramSize program_size(m_impl->program_size);
-	haldls::v2::FlyspiResultAddress result_address(m_impl->result_address);
-
-	halco::common::Unique unique;
-
-	ocp_write_container(m_impl->com, unique, program_address);
-	ocp_write_container(m_impl->com, unique, program_size);
-	ocp_write_container(m_impl->com, unique, result_address);
+	// Anonymous program data, not to be matched against playback programs
+	m_impl->program_serial_number = haldls::v2::PlaybackProgram::invalid_serial_number;
 }
 
 void LocalBoardControl::transfer(haldls::v2::PlaybackProgram const& playback_program)
@@ -273,13 +1209,45 @@ void LocalBoardControl::transfer(haldls::v2::PlaybackProgram const& playback_pro
 	if (!m_impl) {
 		throw std::logic_error("unexpected access to moved-from object");
 	}
+	m_impl->check_no_pending_runs();
 
 	if (playback_program.serial_number() == haldls::v2::PlaybackProgram::invalid_serial_number) {
 		throw std::logic_error("trying to transfer program with invalid state");
 	}
 
+	if (playback_program.segment_count() > 1) {
+		throw std::logic_error("trying to transfer program split into segments, use run()");
+	}
+
+	if (playback_program.alters_capmem()) {
+		m_impl->capmem_shadow.reset();
+	}
+
+	auto const& program_bytes = playback_program.instruction_byte_blocks();
+	auto const& patched_byte_ranges = playback_program.patched_byte_ranges();
+
+	ResidentPrograms::key_type const key(
+		ResidentPrograms::KeyKind::serial_number, playback_program.serial_number());
+	hate::optional<std::size_t> transferred_range_count;
+	auto* program = m_impl->resident_programs.find(
+		key, [&playback_program, &transferred_range_count](ResidentProgram const& resident) {
+			transferred_range_count =
+				playback_program.patched_byte_range_count(resident.patch_version);
+			return static_cast<bool>(transferred_range_count);
+		});
+	if (program) {
+		// Program is resident already, only re-send the data modified since its transfer
+		transfer_byte_ranges(
+			m_impl->com, program->address, program_bytes,
+			{std::next(patched_byte_ranges.cbegin(), *transferred_range_count),
+			 patched_byte_ranges.cend()});
+	} else {
+		program = &m_impl->resident_programs.insert(key, size_in_words(program_bytes));
+		program->size = m_impl->upload_program(program->address, program_bytes);
+	}
+	program->patch_version = playback_program.patch_version();
+	m_impl->select_program(program->address, program->size, 0);
 	m_impl->program_serial_number = playback_program.serial_number();
-	transfer(playback_program.instruction_byte_blocks());
 }
 
 void LocalBoardControl::execute(
@@ -288,133 +1256,50 @@ void LocalBoardControl::execute(
     std::chrono::microseconds max_wait,
     hate::optional<std::chrono::microseconds> expected_runtime)
 {
-	auto log = log4cxx::Logger::getLogger(__func__);
-
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
 
 	if (m_impl->program_size == 0)
 		throw std::runtime_error("execute: no valid playback program has been transferred yet");
 
-	halco::common::Unique unique;
-
-	// check that the DLS is not in reset
-	auto config = ocp_read_container<haldls::v2::FlyspiConfig>(m_impl->com, unique);
-	if (config.get_dls_reset()) {
-		LOG4CXX_ERROR(log, "Asking to execute a program although the DLS is in reset.");
-		LOG4CXX_ERROR(log, "This is prohibited for v2 as it will freeze the system.");
-		throw haldls::exception::InvalidConfiguration(
-			"Refuse to execute playback program with DLSv2 in reset");
-	}
-
-	// start execution by setting the execute bit
-	haldls::v2::FlyspiControl control;
-	control.set_execute(true);
-	LOG4CXX_DEBUG(log, "start execution");
-	ocp_write_container(m_impl->com, unique, control);
-
-	// wait until execute bit is cleared again
-	{
-		if (expected_runtime) {
-			std::this_thread::sleep_for(*expected_runtime);
-		}
-		std::chrono::microseconds waited(0);
-		std::chrono::microseconds wait_period(min_wait_period);
-		while (control.get_execute()) {
-			LOG4CXX_DEBUG(
-			    log, "execute flag not yet cleared, sleep for " << wait_period.count() << "us");
-			std::this_thread::sleep_for(wait_period);
-			control = ocp_read_container<haldls::v2::FlyspiControl>(m_impl->com, unique);
-
-			if (waited.count() > max_wait.count()) {
-				LOG4CXX_ERROR(
-				    log, "execute flag not cleared for " << max_wait.count() << "us, aborting!");
-				auto exception =
-					ocp_read_container<haldls::v2::FlyspiException>(m_impl->com, unique);
-				LOG4CXX_ERROR(log, exception)
-				break;
-			}
-			// Exponentially increase sleep time until max. specified
-			if (wait_period.count() < max_wait_period.count()) {
-				wait_period *= 2;
-				if (wait_period.count() > max_wait_period.count()) {
-					wait_period = max_wait_period;
-				}
-			}
-			waited += wait_period;
-		}
-	}
-	LOG4CXX_DEBUG(log, "execution finished");
+	m_impl->start_execution();
+	m_impl->wait_for_execution(min_wait_period, max_wait_period, max_wait, expected_runtime);
 }
 
 void LocalBoardControl::execute()
 {
 	execute(
-	    std::chrono::microseconds(50), // legacy value
-	    // 10ms max. period time for fine enough resolution in short sweeps
-	    std::chrono::microseconds(10000),
-	    // typical experiments don't last longer than 60s (PSP: 19.11.2018, OJB: 23.05.2018)
-	    std::chrono::microseconds(60*1000*1000));
+	    Impl::default_min_wait_period, Impl::default_max_wait_period, Impl::default_max_wait);
 }
 
 std::vector<haldls::v2::instruction_word_type> LocalBoardControl::fetch()
 {
-	auto log = log4cxx::Logger::getLogger(__func__);
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
 
 	if (m_impl->program_size == 0)
 		throw std::runtime_error("fetch: no valid playback program has been transferred yet");
 
-	// get result size
-	halco::common::Unique unique;
-	auto result_size = ocp_read_container<haldls::v2::FlyspiResultSize>(m_impl->com, unique);
-	if (!result_size.get_value()) {
-		throw std::logic_error("no result size read from board");
-	}
-	if (result_size.get_value().value() > rw_api::FlyspiCom::SdramChannel::max_size) {
-		throw std::logic_error(
-			"to be read back data(" + std::to_string(result_size.get_value().value()) +
-			") exceeds FPGA memory(" + std::to_string(rw_api::FlyspiCom::SdramChannel::max_size) + ")");
-	}
-	auto exception = ocp_read_container<haldls::v2::FlyspiException>(m_impl->com, unique);
-	if (!exception.check().value()) {
-		LOG4CXX_ERROR(log, "FPGA exception raised: " << exception);
-		throw std::logic_error("FPGA exception raised, aborting fetching");
-	}
-
-	// vvv ------8<----------- (legacy code copied from frickel-dls)
-
-	using namespace rw_api::flyspi;
-
-	// transfer data back
-	auto loc = (m_impl->com).locate().chip(0);
-	SdramBlockReadQuery q_read((m_impl->com), loc, result_size.get_value().value());
-	q_read.addr(0x08000000 + m_impl->result_address);
-
-	auto r_read = q_read.commit();
-	r_read.wait();
-
-	// ^^^ ------8<-----------
-
-	// extract read/write results from data
-
-	std::vector<haldls::v2::instruction_word_type> bytes;
-	std::copy(
-		uni::raw_byte_iterator<rw_api::FlyspiCom::BufferType>(std::begin(r_read)),
-		uni::raw_byte_iterator<rw_api::FlyspiCom::BufferType>(std::end(r_read)),
-		std::back_inserter(bytes));
-	return bytes;
+	return m_impl->read_results(m_impl->result_address, m_impl->result_size());
 }
 
 void LocalBoardControl::fetch(haldls::v2::PlaybackProgram& playback_program)
 {
 	if (!m_impl)
 		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
 
 	if (m_impl->program_serial_number != playback_program.serial_number())
 		throw std::runtime_error("Different playback program as transferred to chip");
-	decode_result_bytes(fetch(), playback_program);
+
+	UniDecoder decoder;
+	decoder.words.reserve(playback_program.read_count());
+	m_impl->decode_results(m_impl->result_address, m_impl->result_size(), decoder);
+	playback_program.set_results(std::move(decoder.words));
+	playback_program.set_spikes(std::move(decoder.spikes));
+	playback_program.set_spike_set_time_counts(std::move(decoder.spike_set_time_counts));
 }
 
 void LocalBoardControl::decode_result_bytes(
@@ -425,6 +1310,7 @@ void LocalBoardControl::decode_result_bytes(
 	uni::decode(result_bytes.begin(), result_bytes.end(), decoder);
 	playback_program.set_results(std::move(decoder.words));
 	playback_program.set_spikes(std::move(decoder.spikes));
+	playback_program.set_spike_set_time_counts(std::move(decoder.spike_set_time_counts));
 }
 
 std::vector<haldls::v2::instruction_word_type> LocalBoardControl::run(
@@ -437,9 +1323,169 @@ std::vector<haldls::v2::instruction_word_type> LocalBoardControl::run(
 
 void LocalBoardControl::run(haldls::v2::PlaybackProgram& playback_program)
 {
+	if (playback_program.segment_count() == 1) {
+		transfer(playback_program);
+		m_impl->start_execution();
+		m_impl->wait_for_estimated_execution(playback_program.estimated_duration());
+		fetch(playback_program);
+		return;
+	}
+
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	if (playback_program.serial_number() == haldls::v2::PlaybackProgram::invalid_serial_number)
+		throw std::logic_error("trying to run program with invalid state");
+
+	if (playback_program.alters_capmem())
+		m_impl->capmem_shadow.reset();
+
+	// Execute segments one after another, results are appended in order, so tickets and
+	// spike result offsets refer to the results of all segments.
+	UniDecoder decoder;
+	decoder.words.reserve(playback_program.read_count());
+	for (std::size_t segment = 0; segment < playback_program.segment_count(); ++segment) {
+		transfer(playback_program.segment_instruction_byte_blocks(segment));
+		execute();
+		m_impl->decode_results(m_impl->result_address, m_impl->result_size(), decoder);
+	}
+	playback_program.set_results(std::move(decoder.words));
+	playback_program.set_spikes(std::move(decoder.spikes));
+	playback_program.set_spike_set_time_counts(std::move(decoder.spike_set_time_counts));
+}
+
+std::vector<haldls::v2::PlaybackProgram> LocalBoardControl::run_pipelined(
+	std::vector<haldls::v2::PlaybackProgram> playback_programs, std::size_t const regions)
+{
+	typedef Impl::hardware_address_type hardware_address_type;
+
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	if (regions < 2)
+		throw std::invalid_argument("pipelined execution requires at least two SDRAM regions");
+
+	hardware_address_type const region_size =
+		rw_api::FlyspiCom::SdramChannel::max_size / regions;
+
+	// Each segment of each program forms a stage of the pipeline.
+	struct Stage
+	{
+		std::size_t program;
+		std::size_t segment;
+		hardware_address_type address;
+	};
+	std::vector<Stage> stages;
+	for (std::size_t program = 0; program < playback_programs.size(); ++program) {
+		auto const& playback_program = playback_programs[program];
+		if (playback_program.serial_number() ==
+			haldls::v2::PlaybackProgram::invalid_serial_number)
+			throw std::logic_error("trying to run program with invalid state");
+		if (playback_program.alters_capmem())
+			m_impl->capmem_shadow.reset();
+		for (std::size_t segment = 0; segment < playback_program.segment_count(); ++segment) {
+			hardware_address_type const address = (stages.size() % regions) * region_size;
+			stages.push_back({program, segment, address});
+		}
+	}
+
+	auto const upload = [this, &playback_programs, region_size](Stage const& stage) {
+		auto const& program_bytes =
+			playback_programs[stage.program].segment_instruction_byte_blocks(stage.segment);
+		std::size_t size = 0;
+		for (auto const& block : program_bytes)
+			size += block.size();
+		if (size / sizeof(Impl::hardware_word_type) > region_size)
+			throw std::logic_error("program exceeds SDRAM region of pipelined execution");
+		return m_impl->upload_program(stage.address, program_bytes);
+	};
+
+	// Programs are not retained, as the regions are reused
+	m_impl->program_serial_number = haldls::v2::PlaybackProgram::invalid_serial_number;
+	m_impl->resident_programs.clear();
+
+	std::vector<UniDecoder> decoders(playback_programs.size());
+	for (std::size_t program = 0; program < playback_programs.size(); ++program)
+		decoders[program].words.reserve(playback_programs[program].read_count());
+	auto const decode = [this, &decoders, region_size](Stage const& stage, std::size_t size) {
+		if (size > region_size)
+			throw std::logic_error("results exceed SDRAM region of pipelined execution");
+		m_impl->decode_results(stage.address, size, decoders[stage.program]);
+	};
+
+	hardware_address_type program_size = stages.empty() ? 0 : upload(stages.front());
+	std::size_t previous_result_size = 0;
+	for (auto it = stages.cbegin(); it != stages.cend(); ++it) {
+		// Results of the previous stage were located already, so its region may be reused.
+		m_impl->select_program(it->address, program_size, it->address);
+		m_impl->start_execution();
+
+		// Transfer the next program and fetch the previous results during execution
+		if (std::next(it) != stages.cend())
+			program_size = upload(*std::next(it));
+		if (it != stages.cbegin())
+			decode(*std::prev(it), previous_result_size);
+
+		m_impl->wait_for_execution();
+		previous_result_size = m_impl->result_size();
+	}
+	if (!stages.empty())
+		decode(stages.back(), previous_result_size);
+
+	for (std::size_t program = 0; program < playback_programs.size(); ++program) {
+		auto& playback_program = playback_programs[program];
+		auto& decoder = decoders[program];
+		playback_program.set_results(std::move(decoder.words));
+		playback_program.set_spikes(std::move(decoder.spikes));
+		playback_program.set_spike_set_time_counts(std::move(decoder.spike_set_time_counts));
+	}
+	return playback_programs;
+}
+
+std::vector<std::vector<haldls::v2::instruction_word_type> > LocalBoardControl::run_repeated(
+	haldls::v2::PlaybackProgram const& playback_program, std::size_t const repetitions)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	// Each read occupies at least one SDRAM word of the results
+	auto const read_count = playback_program.read_count();
+	if (read_count && repetitions > rw_api::FlyspiCom::SdramChannel::max_size / read_count)
+		throw std::logic_error(
+			"results of " + std::to_string(repetitions) + " repetitions exceed FPGA memory(" +
+			std::to_string(rw_api::FlyspiCom::SdramChannel::max_size) + ")");
+
 	transfer(playback_program);
-	execute();
-	fetch(playback_program);
+
+	// Results of consecutive repetitions are placed back to back
+	std::vector<std::size_t> result_sizes;
+	result_sizes.reserve(repetitions);
+	std::size_t result_size = 0;
+	for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+		m_impl->select_result_address(result_size);
+		m_impl->start_execution();
+		m_impl->wait_for_estimated_execution(playback_program.estimated_duration());
+		result_sizes.push_back(m_impl->result_size());
+		result_size += result_sizes.back();
+		if (result_size > rw_api::FlyspiCom::SdramChannel::max_size)
+			throw std::logic_error(
+				"results of " + std::to_string(repetition + 1) + " repetitions exceed FPGA memory(" +
+				std::to_string(rw_api::FlyspiCom::SdramChannel::max_size) + ")");
+	}
+
+	// Fetch the results of all repetitions at once, splitting them per repetition
+	std::vector<std::vector<haldls::v2::instruction_word_type> > result_bytes(repetitions);
+	ChunkedResultReader reader(m_impl->com, 0, result_size, Impl::result_chunk_size);
+	for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+		auto& bytes = result_bytes[repetition];
+		bytes.reserve(result_sizes[repetition] * sdram_word_size);
+		reader.set_available(result_sizes[repetition] * sdram_word_size);
+		std::copy(reader.begin(), reader.end(), std::back_inserter(bytes));
+	}
+	return result_bytes;
 }
 
 void LocalBoardControl::run_experiment(
@@ -451,6 +1497,117 @@ void LocalBoardControl::run_experiment(
 	run(playback_program);
 }
 
+void LocalBoardControl::set_spin_polling(hate::optional<SpinPolling> const& spin_polling)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	m_impl->set_spin_polling(spin_polling);
+}
+
+hate::optional<SpinPolling> LocalBoardControl::get_spin_polling() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	return m_impl->spin_polling;
+}
+
+ExecutionStatistics LocalBoardControl::get_last_execution_statistics() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	return m_impl->last_execution_statistics;
+}
+
+void LocalBoardControl::invalidate_board_shadow()
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	m_impl->board_shadow.reset();
+	m_impl->flyspi_config_shadow.reset();
+}
+
+void LocalBoardControl::invalidate()
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	m_impl->invalidate();
+}
+
+ResidentProgramStatistics LocalBoardControl::get_resident_program_statistics() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	return m_impl->resident_programs.get_statistics();
+}
+
+void LocalBoardControl::reset_resident_program_statistics()
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	m_impl->resident_programs.reset_statistics();
+}
+
+void LocalBoardControl::set_capmem_settle_duration(std::chrono::microseconds const value)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	m_impl->capmem_settle_duration = value;
+}
+
+std::chrono::microseconds LocalBoardControl::get_capmem_settle_duration() const
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	return m_impl->capmem_settle_duration;
+}
+
+void LocalBoardControl::invalidate_capmem_shadow()
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+	m_impl->check_no_pending_runs();
+
+	m_impl->capmem_shadow.reset();
+}
+
+std::future<void> LocalBoardControl::run_async(haldls::v2::PlaybackProgram& playback_program)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->submit_run([this, &playback_program]() { run(playback_program); });
+}
+
+std::future<void> LocalBoardControl::run_experiment_async(
+	haldls::v2::Board const& board,
+	haldls::v2::Chip const& chip,
+	haldls::v2::PlaybackProgram& playback_program)
+{
+	if (!m_impl)
+		throw std::logic_error("unexpected access to moved-from object");
+
+	return m_impl->submit_run(
+		[this, board, chip, &playback_program]() { run_experiment(board, chip, playback_program); });
+}
+
 std::vector<std::string> available_board_usb_serial_numbers()
 {
 	std::vector<std::string> result;
@@ -1,5 +1,7 @@
 #include "stadls/v2/ocp.h"
 
+#include <utility>
+
 #include "flyspi-rw_api/flyspi_com.h"
 
 #include "stadls/visitors.h"
@@ -60,15 +62,17 @@ template <class T>
 void ocp_write_container(
 	rw_api::FlyspiCom& com, typename T::coordinate_type const& coord, T const& container)
 {
-	typedef std::vector<haldls::v2::ocp_address_type> ocp_addresses_type;
-	typedef std::vector<haldls::v2::ocp_word_type> ocp_words_type;
+	typedef std::vector<std::pair<haldls::v2::ocp_address_type, haldls::v2::ocp_word_type> >
+		data_type;
 
-	ocp_addresses_type addresses;
-	visit_preorder(container, coord, WriteAddressVisitor<ocp_addresses_type>{addresses});
-	ocp_words_type words;
-	visit_preorder(container, coord, EncodeVisitor<ocp_words_type>{words});
+	data_type data;
+	data.reserve(haldls::v2::detail::ConfigSizeInWords<T>::value);
+	visit_preorder(container, coord, WriteEncodeVisitor<data_type>{data});
 
-	ocp_write(com, words, addresses);
+	auto const loc = com.locate().chip(0);
+	for (auto const& entry : data) {
+		rw_api::flyspi::ocpWrite(com, loc, entry.first.value, entry.second.value);
+	}
 }
 
 // Explicit instantiation of template functions for all valid ocp container types.
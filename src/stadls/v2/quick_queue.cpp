@@ -3,13 +3,18 @@
 #include <SF/vector.hpp>
 
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <thread>
 #include <unordered_map> // needed for std::hash<std::string>
 #include <cereal/archives/binary.hpp>
 #include <cereal/cereal.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/string.hpp>
 #include <cereal/types/vector.hpp>
 #include <sys/wait.h>
 
@@ -26,6 +31,7 @@
 #include "haldls/v2/common.h"
 #include "haldls/v2/playback.h"
 #include "haldls/v2/spike.h"
+#include "stadls/v2/configuration_cache.h"
 #include "stadls/v2/local_board_control.h"
 #include "stadls/v2/ocp.h"
 #include "stadls/visitors.h"
@@ -34,6 +40,10 @@
 #include <munge.h>
 #endif
 
+#ifdef USE_ZSTD_COMPRESSION
+#include <zstd.h>
+#endif
+
 namespace SF {
 
 void serialize(SF::Archive& ar, haldls::v2::ocp_address_type& addr)
@@ -51,31 +61,276 @@ void serialize(SF::Archive& ar, haldls::v2::ocp_word_type& word)
 namespace stadls {
 namespace v2 {
 
+namespace {
+
+typedef std::vector<haldls::v2::instruction_word_type> bytes_type;
+
+/// \brief Append the size as 64 bit little endian integer.
+void append_size(bytes_type& bytes, std::uint64_t const size)
+{
+	for (std::size_t ii = 0; ii < sizeof(size); ++ii)
+		bytes.push_back(static_cast<haldls::v2::instruction_word_type>(size >> (8 * ii)));
+}
+
+std::uint64_t extract_size(bytes_type::const_iterator& it, bytes_type::const_iterator const end)
+{
+	if (static_cast<std::size_t>(std::distance(it, end)) < sizeof(std::uint64_t))
+		throw std::runtime_error("truncated quick queue payload");
+
+	std::uint64_t size = 0;
+	for (std::size_t ii = 0; ii < sizeof(size); ++ii, ++it)
+		size |= static_cast<std::uint64_t>(*it) << (8 * ii);
+	return size;
+}
+
+void append_blocks(bytes_type& bytes, program_bytes_type const& blocks)
+{
+	append_size(bytes, blocks.size());
+	for (auto const& block : blocks) {
+		append_size(bytes, block.size());
+		bytes.insert(bytes.end(), block.cbegin(), block.cend());
+	}
+}
+
+program_bytes_type extract_blocks(
+	bytes_type::const_iterator& it, bytes_type::const_iterator const end)
+{
+	program_bytes_type blocks(extract_size(it, end));
+	for (auto& block : blocks) {
+		auto const size = extract_size(it, end);
+		if (static_cast<std::uint64_t>(std::distance(it, end)) < size)
+			throw std::runtime_error("truncated quick queue payload");
+		block.assign(it, it + size);
+		it += size;
+	}
+	return blocks;
+}
+
+compressed_payload_type compress_bytes(bytes_type const& bytes, int const level)
+{
+#ifdef USE_ZSTD_COMPRESSION
+	compressed_payload_type compressed(ZSTD_compressBound(bytes.size()));
+	auto const size =
+		ZSTD_compress(compressed.data(), compressed.size(), bytes.data(), bytes.size(), level);
+	if (ZSTD_isError(size))
+		throw std::runtime_error(
+			std::string("compression of quick queue payload failed: ") +
+			ZSTD_getErrorName(size));
+	compressed.resize(size);
+	return compressed;
+#else
+	static_cast<void>(bytes);
+	static_cast<void>(level);
+	throw std::logic_error("built without quick queue compression support");
+#endif
+}
+
+bytes_type decompress_bytes(compressed_payload_type const& compressed)
+{
+#ifdef USE_ZSTD_COMPRESSION
+	auto const content_size = ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+	if (content_size == ZSTD_CONTENTSIZE_ERROR || content_size == ZSTD_CONTENTSIZE_UNKNOWN)
+		throw std::runtime_error("invalid compressed quick queue payload");
+	// The content size is read from the untrusted frame header, bound the allocation
+	if (content_size > static_cast<unsigned long long>(QuickQueueClient::max_message_length))
+		throw std::runtime_error("compressed quick queue payload exceeds maximal message length");
+
+	bytes_type bytes(content_size);
+	auto const size =
+		ZSTD_decompress(bytes.data(), bytes.size(), compressed.data(), compressed.size());
+	if (ZSTD_isError(size))
+		throw std::runtime_error(
+			std::string("decompression of quick queue payload failed: ") +
+			ZSTD_getErrorName(size));
+	bytes.resize(size);
+	return bytes;
+#else
+	static_cast<void>(compressed);
+	throw std::logic_error("built without quick queue compression support");
+#endif
+}
+
+std::size_t size_in_bytes(
+	ocp_addresses_type const& board_addresses,
+	ocp_words_type const& board_words,
+	program_bytes_type const& chip_program_bytes,
+	capmem_words_type const& chip_capmem_words)
+{
+	std::size_t size = board_addresses.size() * sizeof(haldls::v2::ocp_address_type) +
+					   board_words.size() * sizeof(haldls::v2::ocp_word_type) +
+					   chip_capmem_words.size() * sizeof(haldls::v2::hardware_word_type);
+	for (auto const& block : chip_program_bytes)
+		size += block.size();
+	return size;
+}
+
+void check_compression_level(int const level)
+{
+	if (level < 0)
+		throw std::invalid_argument("compression level has to be non-negative");
+	if (level == 0)
+		return;
+	if (!quick_queue_compression_available())
+		throw std::invalid_argument("built without quick queue compression support");
+#ifdef USE_ZSTD_COMPRESSION
+	if (level > ZSTD_maxCLevel())
+		throw std::invalid_argument(
+			"compression level exceeds maximum of " + std::to_string(ZSTD_maxCLevel()));
+#endif
+}
+
+} // namespace
+
+bool quick_queue_compression_available()
+{
+#ifdef USE_ZSTD_COMPRESSION
+	return true;
+#else
+	return false;
+#endif
+}
+
+configuration_digest_type quick_queue_configuration_digest(QuickQueueRequest const& request)
+{
+	Sha256 sha;
+	sha.update_value<std::uint64_t>(request.board_addresses.size());
+	for (auto const address : request.board_addresses)
+		sha.update_value(address.value);
+	sha.update_value<std::uint64_t>(request.board_words.size());
+	for (auto const word : request.board_words)
+		sha.update_value(word.value);
+	sha.update_value<std::uint64_t>(request.chip_program_bytes.size());
+	for (auto const& block : request.chip_program_bytes) {
+		sha.update_value<std::uint64_t>(block.size());
+		sha.update(block.data(), block.size());
+	}
+	sha.update_value<std::uint64_t>(request.chip_capmem_words.size());
+	sha.update(request.chip_capmem_words.cbegin(), request.chip_capmem_words.cend());
+	return sha.digest();
+}
+
+std::string quick_queue_user_data()
+{
+#ifdef USE_MUNGE_AUTH
+	char* cred;
+	munge_err_t const err = munge_encode(&cred, NULL, NULL, 0);
+	if (err != EMUNGE_SUCCESS)
+		throw std::runtime_error(std::string("munge encoding failed: ") + munge_strerror(err));
+	std::string const user_data(cred);
+	free(cred);
+	return user_data;
+#else
+	char const* const user = std::getenv("USER");
+	return std::string(user ? user : "") + "-without-authentication";
+#endif
+}
+
+void QuickQueueRequest::omit_configuration()
+{
+	if (compression_level)
+		throw std::logic_error("configuration of compressed request cannot be omitted");
+
+	board_addresses.clear();
+	board_words.clear();
+	chip_program_bytes.clear();
+	chip_capmem_words.clear();
+	configuration_omitted = true;
+}
+
+void QuickQueueRequest::compress(int const level)
+{
+	check_compression_level(level);
+	if (compression_level)
+		throw std::logic_error("request is already compressed");
+	if (!level)
+		return;
+
+	bytes_type bytes;
+	append_blocks(bytes, chip_program_bytes);
+	append_blocks(bytes, playback_program_bytes);
+	compressed_payload = compress_bytes(bytes, level);
+	compression_level = level;
+	chip_program_bytes.clear();
+	playback_program_bytes.clear();
+}
+
+void QuickQueueRequest::decompress()
+{
+	if (!compression_level)
+		return;
+
+	auto const bytes = decompress_bytes(compressed_payload);
+	auto it = bytes.cbegin();
+	chip_program_bytes = extract_blocks(it, bytes.cend());
+	playback_program_bytes = extract_blocks(it, bytes.cend());
+	compressed_payload.clear();
+	compression_level = 0;
+}
+
+void QuickQueueResponse::compress(int const level)
+{
+	check_compression_level(level);
+	if (compression_level)
+		throw std::logic_error("response is already compressed");
+	if (!level)
+		return;
+
+	compressed_payload = compress_bytes(result_bytes, level);
+	compression_level = level;
+	result_bytes.clear();
+}
+
+void QuickQueueResponse::decompress()
+{
+	if (!compression_level)
+		return;
+
+	result_bytes = decompress_bytes(compressed_payload);
+	compressed_payload.clear();
+	compression_level = 0;
+}
+
 template <class Archive>
 void QuickQueueRequest::serialize_detail(Archive& archive, std::false_type)
 {
 	archive(CEREAL_NVP(board_addresses));
 	archive(CEREAL_NVP(board_words));
 	archive(CEREAL_NVP(chip_program_bytes));
+	archive(CEREAL_NVP(chip_capmem_words));
 	archive(CEREAL_NVP(playback_program_bytes));
+	archive(CEREAL_NVP(playback_program_alters_capmem));
+	archive(CEREAL_NVP(configuration_digest));
+	archive(CEREAL_NVP(configuration_omitted));
+	archive(CEREAL_NVP(user_data));
+	archive(CEREAL_NVP(compression_level));
+	archive(CEREAL_NVP(compressed_payload));
 }
 
 template <class Archive>
 void QuickQueueRequest::serialize_detail(Archive& ar, std::true_type)
 {
-	ar& board_addresses& board_words& chip_program_bytes& playback_program_bytes;
+	ar& board_addresses& board_words& chip_program_bytes& chip_capmem_words&
+		playback_program_bytes& playback_program_alters_capmem;
+	for (auto& byte : configuration_digest)
+		ar& byte;
+	ar& configuration_omitted& user_data& compression_level& compressed_payload;
 }
 
 template <class Archive>
 void QuickQueueResponse::serialize_detail(Archive& archive, std::false_type)
 {
 	archive(CEREAL_NVP(result_bytes));
+	archive(CEREAL_NVP(compression_level));
+	archive(CEREAL_NVP(compressed_payload));
+	archive(CEREAL_NVP(compression_unsupported));
+	archive(CEREAL_NVP(configuration_miss));
 }
 
 template <class Archive>
 void QuickQueueResponse::serialize_detail(Archive& ar, std::true_type)
 {
-	ar& result_bytes;
+	ar& result_bytes& compression_level& compressed_payload& compression_unsupported&
+		configuration_miss;
 }
 
 // excplicit instantiation to fix build problems with jenkins (builds locally but fails with missing
@@ -92,18 +347,27 @@ QuickQueueRequest create_request(
 {
 	QuickQueueRequest req;
 
-	halco::common::Unique const coord;
-	visit_preorder(board, coord, WriteAddressVisitor<ocp_addresses_type>{req.board_addresses});
-	visit_preorder(board, coord, EncodeVisitor<ocp_words_type>{req.board_words});
+	auto& cache = ConfigurationCache::instance();
+	auto const board_words = cache.get_board_words(board);
+	req.board_addresses = board_words->addresses;
+	req.board_words = board_words->words;
 
-	req.chip_program_bytes = get_configure_program(chip).instruction_byte_blocks();
+	req.chip_program_bytes = *cache.get_configure_program_bytes(chip);
+	req.chip_capmem_words = get_capmem_words(board, chip);
 	req.playback_program_bytes = playback_program.instruction_byte_blocks();
+	req.playback_program_alters_capmem = playback_program.alters_capmem();
+	req.configuration_digest = quick_queue_configuration_digest(req);
 	return req;
 }
 
 
 QuickQueueWorker::QuickQueueWorker(std::string const& usb_serial)
-	: m_usb_serial(usb_serial), m_has_slurm_allocation(false), m_mock_mode(false)
+	: m_usb_serial(usb_serial),
+	  m_has_slurm_allocation(false),
+	  m_mock_mode(false),
+	  m_configuration_cache(ConfigurationCache::default_max_size_in_bytes),
+	  m_configuration_cache_hits(0),
+	  m_configuration_cache_misses(0)
 {
 	char const* env_partition = std::getenv(m_env_name_partition);
 	if (env_partition == nullptr) {
@@ -115,6 +379,42 @@ QuickQueueWorker::QuickQueueWorker(std::string const& usb_serial)
 
 QuickQueueWorker::~QuickQueueWorker() = default;
 
+std::size_t QuickQueueWorker::ConfigurationKeyHash::operator()(
+	configuration_key_type const& key) const
+{
+	// The digest is uniformly distributed, its leading bytes suffice as hash value.
+	std::size_t hash = key.first;
+	for (std::size_t ii = 0; ii < sizeof(hash); ++ii)
+		hash ^= static_cast<std::size_t>(key.second[ii]) << (8 * ii);
+	return hash;
+}
+
+void QuickQueueWorker::set_capmem_settle_duration(std::chrono::microseconds const value)
+{
+	m_capmem_settle_duration = value;
+	if (m_local_board_ctrl) {
+		m_local_board_ctrl->set_capmem_settle_duration(value);
+	}
+}
+
+ConfigurationCache::Statistics QuickQueueWorker::get_configuration_cache_statistics() const
+{
+	return {m_configuration_cache_hits, m_configuration_cache_misses,
+	        m_configuration_cache.entries(), m_configuration_cache.size(),
+	        m_configuration_cache.max_size()};
+}
+
+void QuickQueueWorker::reset_configuration_cache_statistics()
+{
+	m_configuration_cache_hits = 0;
+	m_configuration_cache_misses = 0;
+}
+
+void QuickQueueWorker::set_configuration_cache_max_size_in_bytes(std::size_t const value)
+{
+	m_configuration_cache.set_max_size(value);
+}
+
 void QuickQueueWorker::get_slurm_allocation()
 {
 	// prevent error if we already have slurm allocation
@@ -167,6 +467,9 @@ void QuickQueueWorker::setup()
 		LOG4CXX_DEBUG(log, "Setting up LocalBoardControl.");
 		// TODO have the experiment control timeout (e.g. when the board is unresponsive)
 		m_local_board_ctrl.reset(new LocalBoardControl(m_usb_serial));
+		if (m_capmem_settle_duration) {
+			m_local_board_ctrl->set_capmem_settle_duration(*m_capmem_settle_duration);
+		}
 	} else {
 		LOG4CXX_DEBUG(log, "Operating in mock-mode - no LocalBoardControl allocated.");
 	}
@@ -180,6 +483,14 @@ void QuickQueueWorker::teardown()
 		free_slurm_allocation();
 	}
 	auto log = log4cxx::Logger::getLogger("QuickQueueWorker");
+	if (log->isEnabledFor(log4cxx::Level::getDebug())) {
+		auto const statistics = get_configuration_cache_statistics();
+		std::stringstream ss;
+		ss << "Configuration cache: " << statistics.hits << " hits, " << statistics.misses
+		   << " misses, " << statistics.entries << " entries, " << statistics.size_in_bytes
+		   << "/" << statistics.max_size_in_bytes << " bytes.";
+		LOG4CXX_DEBUG(log, ss.str());
+	}
 	LOG4CXX_DEBUG(log, "TearDown completed!");
 }
 
@@ -215,20 +526,77 @@ void QuickQueueWorker::free_slurm_allocation()
 	}
 }
 
-QuickQueueResponse QuickQueueWorker::work(QuickQueueRequest const& req)
+QuickQueueResponse QuickQueueWorker::work(QuickQueueRequest const& compressed_req)
 {
 	auto log = log4cxx::Logger::getLogger("QuickQueueWorker");
 	QuickQueueResponse response;
 
+	if (compressed_req.compression_level && !quick_queue_compression_available()) {
+		LOG4CXX_WARN(log, "Received compressed request without compression support.");
+		response.compression_unsupported = true;
+		return response;
+	}
+
+	// the program bytes of compressed requests are only contained in the compressed payload
+	QuickQueueRequest decompressed_req;
+	if (compressed_req.compression_level) {
+		decompressed_req = compressed_req;
+		decompressed_req.decompress();
+	}
+	auto const& req = compressed_req.compression_level ? decompressed_req : compressed_req;
+
+	auto const user = verify_user(req.user_data);
+	if (!user) {
+		throw std::invalid_argument("unable to verify user of request");
+	}
+
+	// Configurations are kept by user and digest, requests omitting their configuration use
+	// a kept one or have to be resent including the configuration.
+	Configuration const* configuration = nullptr;
+	if (req.configuration_omitted) {
+		configuration = m_configuration_cache.find({*user, req.configuration_digest});
+		if (!configuration) {
+			++m_configuration_cache_misses;
+			LOG4CXX_DEBUG(log, "Configuration of request unknown, requesting upload.");
+			response.configuration_miss = true;
+			return response;
+		}
+		++m_configuration_cache_hits;
+	} else {
+		auto const digest = quick_queue_configuration_digest(req);
+		if (req.configuration_digest != digest) {
+			throw std::invalid_argument("configuration digest of request does not match");
+		}
+		m_configuration_cache.insert(
+			{*user, digest},
+			Configuration{req.board_addresses, req.board_words, req.chip_program_bytes,
+			              req.chip_capmem_words},
+			size_in_bytes(
+				req.board_addresses, req.board_words, req.chip_program_bytes,
+				req.chip_capmem_words));
+	}
+	auto const& board_addresses =
+		configuration ? configuration->board_addresses : req.board_addresses;
+	auto const& board_words = configuration ? configuration->board_words : req.board_words;
+	auto const& chip_program_bytes =
+		configuration ? configuration->chip_program_bytes : req.chip_program_bytes;
+	auto const& chip_capmem_words =
+		configuration ? configuration->chip_capmem_words : req.chip_capmem_words;
+
 	if (m_mock_mode) {
 		LOG4CXX_DEBUG(log, "Running mock-experiment!");
 		return response;
 	}
 	LOG4CXX_DEBUG(log, "Running experiment!");
 
+	// The analog configuration of the board is retained between requests, the cap-mem settle
+	// wait is skipped if it is unchanged.
 	m_local_board_ctrl->configure_static(
-		req.board_addresses, req.board_words, req.chip_program_bytes);
+		board_addresses, board_words, chip_program_bytes, chip_capmem_words);
 	try {
+		if (req.playback_program_alters_capmem) {
+			m_local_board_ctrl->invalidate_capmem_shadow();
+		}
 		response.result_bytes = m_local_board_ctrl->run(req.playback_program_bytes);
 	} catch (const rw_api::LogicError& e) {
 		// TODO: Power cycle board
@@ -236,6 +604,7 @@ QuickQueueResponse QuickQueueWorker::work(QuickQueueRequest const& req)
 		LOG4CXX_ERROR(log, "FPGA seems to be hung.");
 		throw;
 	}
+	response.compress(compressed_req.compression_level);
 	return response;
 }
 
@@ -275,9 +644,13 @@ struct QuickQueueClient::Impl
 
 	void setup_client(const std::string& std, uint16_t port);
 
+	/// \brief Submit the request with a new credential of the user.
+	QuickQueueResponse submit(QuickQueueRequest& req);
+
 	typedef typename QuickQueueServer::rcf_interface_t rcf_interface_t;
 
 	std::unique_ptr<RcfClient<rcf_interface_t> > m_client;
+	int m_compression_level = 0;
 };
 
 QuickQueueClient::Impl::Impl()
@@ -312,6 +685,15 @@ void QuickQueueClient::Impl::setup_client(const std::string& ip, uint16_t port)
 		LOG4CXX_DEBUG(log, ss.str());
 	}
 
+	if (quick_queue_compression_available()) {
+		m_compression_level = default_compression_level;
+	}
+	char const* env_compression_level = std::getenv(env_name_compression_level);
+	if (env_compression_level != nullptr) {
+		m_compression_level = atoi(env_compression_level);
+		check_compression_level(m_compression_level);
+	}
+
 	RCF::init();
 	m_client.reset(new RcfClient<rcf_interface_t>(RCF::TcpEndpoint(ip, port)));
 
@@ -319,22 +701,7 @@ void QuickQueueClient::Impl::setup_client(const std::string& ip, uint16_t port)
 	// TODO: How long should we wait for an experiment to finish?
 	m_client->getClientStub().setRemoteCallTimeoutMs(remote_call_timeout);
 
-#ifdef USE_MUNGE_AUTH
-	char* cred;
-	munge_err_t err;
-
-	err = munge_encode(&cred, NULL, NULL, 0);
-	if (err != EMUNGE_SUCCESS) {
-		std::stringstream ss;
-		ss << "ERROR: " << munge_strerror(err);
-		LOG4CXX_ERROR(log, ss.str());
-	}
-	m_client->getClientStub().setRequestUserData(std::string(cred));
-	free(cred);
-#else
-	m_client->getClientStub().setRequestUserData(
-		std::string(std::getenv("USER")) + "-without-authentication");
-#endif
+	m_client->getClientStub().setRequestUserData(quick_queue_user_data());
 }
 
 QuickQueueClient::Impl::~Impl()
@@ -356,6 +723,17 @@ QuickQueueClient& QuickQueueClient::operator=(QuickQueueClient&&) noexcept = def
 
 QuickQueueClient::~QuickQueueClient() {}
 
+void QuickQueueClient::set_compression_level(int const level)
+{
+	check_compression_level(level);
+	m_impl->m_compression_level = level;
+}
+
+int QuickQueueClient::get_compression_level() const
+{
+	return m_impl->m_compression_level;
+}
+
 void QuickQueueClient::run_experiment(
 	haldls::v2::Board const& board,
 	haldls::v2::Chip const& chip,
@@ -363,9 +741,37 @@ void QuickQueueClient::run_experiment(
 {
 	auto log = log4cxx::Logger::getLogger("QuickQueueClient");
 
+	// Only send the hash of the configuration, which is uploaded on a miss
 	QuickQueueRequest req = create_request(board, chip, playback_program);
+	req.omit_configuration();
+	req.compress(m_impl->m_compression_level);
+
+	QuickQueueResponse response = m_impl->submit(req);
+	if (response.compression_unsupported) {
+		LOG4CXX_WARN(log, "Server does not support compression, resending uncompressed.");
+		m_impl->m_compression_level = 0;
+		req.decompress();
+		response = m_impl->submit(req);
+	}
+	if (response.configuration_miss) {
+		LOG4CXX_DEBUG(log, "Configuration unknown to server, resending including it.");
+		req = create_request(board, chip, playback_program);
+		req.compress(m_impl->m_compression_level);
+		response = m_impl->submit(req);
+	}
+	response.decompress();
+
+	// decode received bytes
+	LocalBoardControl::decode_result_bytes(response.result_bytes, playback_program);
+}
+
+QuickQueueResponse QuickQueueClient::Impl::submit(QuickQueueRequest& req)
+{
+	auto log = log4cxx::Logger::getLogger("QuickQueueClient");
 	QuickQueueResponse response;
 
+	req.user_data = quick_queue_user_data();
+
 	// TODO make adjustable
 	size_t max_connection_attempts = 10;
 	size_t wait_after_connection_attempt_secs = 1;
@@ -374,7 +780,7 @@ void QuickQueueClient::run_experiment(
 		 ++num_connection_attempts) {
 		// build request and send it to server
 		try {
-			response = m_impl->m_client->submit_work(req);
+			response = m_client->submit_work(req);
 			break;
 		} catch (const RCF::Exception& e) {
 			if (e.getErrorId() != RCF::RcfError_ClientConnectFail ||
@@ -392,9 +798,7 @@ void QuickQueueClient::run_experiment(
 		LOG4CXX_INFO(log, ss.str());
 		std::this_thread::sleep_for(std::chrono::seconds(wait_after_connection_attempt_secs));
 	}
-
-	// decode received bytes
-	LocalBoardControl::decode_result_bytes(response.result_bytes, playback_program);
+	return response;
 }
 
 } // namespace v2
@@ -94,6 +94,7 @@ int main(int argc, const char* argv[])
 	size_t log_level;
 	size_t num_threads_input;
 	size_t num_threads_output;
+	size_t configuration_cache_mib;
 	bool mock_mode;
 
 	po::options_description desc("Allowed options");
@@ -112,6 +113,11 @@ int main(int argc, const char* argv[])
 		"Number of threads handling incoming connections.")(
 		"num-threads-outputs,m", po::value<size_t>(&num_threads_output)->default_value(8),
 		"Number of threads handling distribution of results.")(
+		"configuration-cache-size",
+		po::value<size_t>(&configuration_cache_mib)
+			->default_value(
+				stadls::v2::ConfigurationCache::default_max_size_in_bytes / (1024 * 1024)),
+		"Memory bound in MiB for configurations kept across requests.")(
 		"mock-mode", po::bool_switch(&mock_mode)->default_value(false),
 		"Operate in mock-mode, i.e., accept connections but return empty results.");
 
@@ -141,6 +147,7 @@ int main(int argc, const char* argv[])
 			LOG4CXX_INFO(log, "Setting mock-mode.");
 		}
 		worker.set_mock_mode(mock_mode);
+		worker.set_configuration_cache_max_size_in_bytes(configuration_cache_mib * 1024 * 1024);
 		server.reset(new stadls::v2::QuickQueueServer(
 			RCF::TcpEndpoint(ip, port), std::move(worker), num_threads_input, num_threads_output));
 	}
@@ -0,0 +1,54 @@
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "halco/hicann-dls/v2/coordinates.h"
+#include "haldls/v2/capmem.h"
+#include "haldls/v2/playback.h"
+#include "stadls/v2/board_pool.h"
+#include "stadls/v2/local_board_control.h"
+
+using namespace halco::common;
+using namespace halco::hicann_dls::v2;
+using namespace haldls::v2;
+using namespace stadls::v2;
+
+#ifndef NO_LOCAL_BOARD
+
+TEST(BoardPool, Map)
+{
+	EXPECT_THROW(BoardPool(std::vector<std::string>{}), std::invalid_argument);
+
+	BoardPool pool;
+	EXPECT_EQ(available_board_usb_serial_numbers().size(), pool.size());
+	EXPECT_EQ(available_board_usb_serial_numbers(), pool.usb_serials());
+
+	std::vector<int> const values{123, 321, 334, 42, 7};
+	std::vector<PoolExperiment> experiments;
+	std::vector<PlaybackProgram::ContainerTicket<CapMemCell> > tickets;
+	PlaybackProgramBuilder builder;
+	for (auto const value : values) {
+		CapMemCellOnDLS const cell(Enum(value % CapMemCellOnDLS::size));
+		builder.write(cell, CapMemCell(CapMemCell::Value(value)));
+		builder.wait_for(1000);
+		tickets.push_back(builder.read<CapMemCell>(cell));
+		builder.halt();
+		experiments.push_back({Board(), Chip(), builder.done()});
+	}
+
+	auto const results = pool.map(experiments);
+	ASSERT_EQ(experiments.size(), results.size());
+	for (std::size_t ii = 0; ii < results.size(); ++ii) {
+		EXPECT_THROW(
+			std::ignore = experiments[ii].playback_program.get(tickets[ii]), std::runtime_error);
+		EXPECT_EQ(
+			CapMemCell::Value(values[ii]),
+			results[ii].playback_program.get(tickets[ii]).get_value());
+	}
+
+	// Errors are rethrown in order of submission
+	std::vector<PoolExperiment> invalid_experiments(1);
+	EXPECT_THROW(pool.map(invalid_experiments), std::logic_error);
+}
+
+#endif
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <limits>
 #include <tuple>
 
 #include <gtest/gtest.h>
@@ -80,6 +82,174 @@ TEST_F(PlaybackTest, CapMem) {
 
 	EXPECT_EQ(capmem_config, capmem_copy);
 	EXPECT_EQ(capmemvalue, capmemcell_copy.get_value());
+
+	// Decoding into an existing container overwrites its previous content
+	CapMem capmem_reused;
+	capmem_reused.set(cell, CapMemCell::Value(12));
+	program.get_into(capmem_ticket, capmem_reused);
+	EXPECT_EQ(capmem_config, capmem_reused);
+	EXPECT_THROW(program.get_into(capmem_ticket_, capmem_reused), std::invalid_argument);
+}
+
+TEST_F(PlaybackTest, Pipelined) {
+	std::vector<PlaybackProgram> programs;
+	std::vector<PlaybackProgram::ContainerTicket<CapMemCell> > tickets;
+	PlaybackProgramBuilder builder;
+	for (auto const value : {123, 321, 334}) {
+		CapMemCellOnDLS const cell(Enum(value % CapMemCellOnDLS::size));
+		builder.write(cell, CapMemCell(CapMemCell::Value(value)));
+		builder.wait_for(1000);
+		tickets.push_back(builder.read<CapMemCell>(cell));
+		builder.halt();
+		programs.push_back(builder.done());
+	}
+
+	LocalBoardControl ctrl(test_board);
+	EXPECT_THROW(ctrl.run_pipelined(programs, 1), std::invalid_argument);
+	auto const results = ctrl.run_pipelined(programs, 2);
+	ASSERT_EQ(programs.size(), results.size());
+
+	for (size_t ii = 0; ii < results.size(); ++ii) {
+		EXPECT_THROW(std::ignore = programs[ii].get(tickets[ii]), std::runtime_error);
+
+		ctrl.run(programs[ii]);
+		EXPECT_EQ(programs[ii].get(tickets[ii]), results[ii].get(tickets[ii]));
+	}
+}
+
+TEST_F(PlaybackTest, Async) {
+	CapMemCellOnDLS const cell(Enum(2));
+	CapMemCell const config(CapMemCell::Value(334));
+
+	PlaybackProgramBuilder builder;
+	builder.write(cell, config);
+	builder.wait_for(1000);
+	auto const ticket = builder.read<CapMemCell>(cell);
+	builder.halt();
+	auto program = builder.done();
+	auto invalid_program = PlaybackProgram();
+
+	LocalBoardControl ctrl(test_board);
+	auto future = ctrl.run_async(program);
+	auto invalid_future = ctrl.run_async(invalid_program);
+
+	future.get();
+	EXPECT_EQ(config, program.get(ticket));
+	EXPECT_THROW(invalid_future.get(), std::logic_error);
+
+	// no runs are pending anymore
+	EXPECT_NO_THROW(ctrl.run(program));
+}
+
+TEST_F(PlaybackTest, SpinPolling) {
+	PlaybackProgramBuilder builder;
+	builder.set_time(0);
+	builder.wait_until(96 * 10);
+	builder.halt();
+	auto program = builder.done();
+
+	LocalBoardControl ctrl(test_board);
+	EXPECT_FALSE(ctrl.get_spin_polling());
+
+	SpinPolling spin_polling;
+	spin_polling.spin_budget = std::chrono::microseconds(100000);
+	ctrl.set_spin_polling(spin_polling);
+	ctrl.run(program);
+
+	auto const statistics = ctrl.get_last_execution_statistics();
+	EXPECT_TRUE(statistics.spun);
+	EXPECT_LE(1u, statistics.polls);
+	EXPECT_LT(std::chrono::nanoseconds(0), statistics.completion_latency);
+}
+
+TEST_F(PlaybackTest, CapMemSettle) {
+	Board board;
+	Chip chip;
+
+	LocalBoardControl ctrl(test_board);
+	std::chrono::microseconds const settle_duration(1000 * 1000);
+	ctrl.set_capmem_settle_duration(settle_duration);
+	EXPECT_EQ(settle_duration, ctrl.get_capmem_settle_duration());
+
+	auto const configure_duration = [&ctrl, &board, &chip]() {
+		auto const begin = std::chrono::steady_clock::now();
+		ctrl.configure_static(board, chip);
+		return std::chrono::steady_clock::now() - begin;
+	};
+
+	EXPECT_LE(settle_duration, configure_duration());
+	// Analog configuration unchanged
+	EXPECT_GT(settle_duration, configure_duration());
+
+	auto capmem = chip.get_capmem();
+	capmem.set(CapMemCellOnDLS(Enum(3)), CapMemCell::Value(123));
+	chip.set_capmem(capmem);
+	EXPECT_LE(settle_duration, configure_duration());
+
+	ctrl.invalidate_capmem_shadow();
+	EXPECT_LE(settle_duration, configure_duration());
+}
+
+TEST_F(PlaybackTest, ResidentPrograms) {
+	std::vector<PlaybackProgram> programs;
+	std::vector<PlaybackProgram::ContainerTicket<CapMemCell> > tickets;
+	PlaybackProgramBuilder builder;
+	for (auto const value : {123, 321}) {
+		CapMemCellOnDLS const cell(Enum(value % CapMemCellOnDLS::size));
+		builder.write(cell, CapMemCell(CapMemCell::Value(value)));
+		tickets.push_back(builder.read<CapMemCell>(cell));
+		builder.halt();
+		programs.push_back(builder.done());
+	}
+
+	LocalBoardControl ctrl(test_board);
+	ctrl.run(programs[0]);
+	ctrl.run(programs[1]);
+	ctrl.reset_resident_program_statistics();
+
+	// Switching between resident programs does not transfer them again
+	ctrl.run(programs[0]);
+	EXPECT_EQ(CapMemCell::Value(123), programs[0].get(tickets[0]).get_value());
+	ctrl.run(programs[1]);
+	EXPECT_EQ(CapMemCell::Value(321), programs[1].get(tickets[1]).get_value());
+
+	auto statistics = ctrl.get_resident_program_statistics();
+	EXPECT_EQ(2, statistics.hits);
+	EXPECT_EQ(0, statistics.misses);
+	EXPECT_EQ(2, statistics.entries);
+	EXPECT_LT(0, statistics.size);
+
+	ctrl.soft_reset();
+	statistics = ctrl.get_resident_program_statistics();
+	EXPECT_EQ(0, statistics.entries);
+	EXPECT_EQ(0, statistics.size);
+}
+
+TEST_F(PlaybackTest, Repeated) {
+	CapMemCellOnDLS const cell(Enum(2));
+	CapMemCell const config(CapMemCell::Value(334));
+
+	PlaybackProgramBuilder builder;
+	builder.write(cell, config);
+	builder.wait_for(1000);
+	auto const ticket = builder.read<CapMemCell>(cell);
+	builder.halt();
+	auto program = builder.done();
+
+	LocalBoardControl ctrl(test_board);
+	EXPECT_TRUE(ctrl.run_repeated(program, 0).empty());
+
+	// results exceeding the SDRAM are rejected prior to execution
+	EXPECT_THROW(
+		ctrl.run_repeated(program, std::numeric_limits<std::size_t>::max()), std::logic_error);
+
+	auto const results = ctrl.run_repeated(program, 5);
+	ASSERT_EQ(5, results.size());
+	EXPECT_THROW(std::ignore = program.get(ticket), std::runtime_error);
+	for (auto const& result : results) {
+		LocalBoardControl::decode_result_bytes(result, program);
+		EXPECT_EQ(config, program.get(ticket));
+	}
 }
 
 TEST_F(PlaybackTest, InvalidState) {
@@ -113,6 +283,13 @@ TEST_F(PlaybackTest, InvalidFPGA)
 	ctrl.transfer(program);
 	EXPECT_THROW(ctrl.execute(), haldls::exception::InvalidConfiguration);
 	EXPECT_THROW(ctrl.run(program), haldls::exception::InvalidConfiguration);
+
+	// the reset state is read from the board if unknown
+	ctrl.invalidate();
+	EXPECT_THROW(ctrl.run(program), haldls::exception::InvalidConfiguration);
+
+	ctrl.configure_static(Board(), chip);
+	EXPECT_NO_THROW(ctrl.run(program));
 }
 
 #endif
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "halco/hicann-dls/v2/coordinates.h"
+#include "haldls/v2/board.h"
+#include "haldls/v2/chip.h"
+#include "stadls/v2/configuration_cache.h"
+#include "stadls/v2/local_board_control.h"
+
+using namespace halco::common;
+using namespace halco::hicann_dls::v2;
+using namespace haldls::v2;
+using namespace stadls::v2;
+
+TEST(ConfigurationCache, Chip)
+{
+	auto& cache = ConfigurationCache::instance();
+	cache.clear();
+	cache.reset_statistics();
+
+	Chip chip;
+	auto const bytes = cache.get_configure_program_bytes(chip);
+	EXPECT_EQ(get_configure_program(chip, 0).instruction_byte_blocks(), *bytes);
+	EXPECT_EQ(0, cache.get_statistics().hits);
+	EXPECT_EQ(1, cache.get_statistics().misses);
+
+	EXPECT_EQ(bytes, cache.get_configure_program_bytes(chip));
+	EXPECT_EQ(1, cache.get_statistics().hits);
+
+	// equal configurations share an entry
+	EXPECT_EQ(bytes, cache.get_configure_program_bytes(Chip()));
+	EXPECT_EQ(2, cache.get_statistics().hits);
+
+	auto capmem = chip.get_capmem();
+	capmem.set(CapMemCellOnDLS(Enum(3)), CapMemCell::Value(123));
+	chip.set_capmem(capmem);
+	auto const other_bytes = cache.get_configure_program_bytes(chip);
+	EXPECT_NE(*bytes, *other_bytes);
+	EXPECT_EQ(2, cache.get_statistics().misses);
+	EXPECT_EQ(2, cache.get_statistics().entries);
+	EXPECT_EQ(
+		2 * ConfigurationCache::default_max_size_in_bytes,
+		cache.get_statistics().max_size_in_bytes);
+
+	// entries exceeding the memory bound are not retained
+	cache.set_max_size_in_bytes(0);
+	EXPECT_EQ(0, cache.get_statistics().entries);
+	cache.get_configure_program_bytes(chip);
+	EXPECT_EQ(0, cache.get_statistics().entries);
+	cache.set_max_size_in_bytes(ConfigurationCache::default_max_size_in_bytes);
+}
+
+TEST(ConfigurationCache, Board)
+{
+	auto& cache = ConfigurationCache::instance();
+	cache.clear();
+	cache.reset_statistics();
+
+	Board board;
+	auto const words = cache.get_board_words(board);
+	EXPECT_EQ(words->addresses.size(), words->words.size());
+	EXPECT_EQ(words, cache.get_board_words(board));
+	EXPECT_EQ(1, cache.get_statistics().hits);
+
+	board.set_parameter(Board::Parameter::syn_v_bias, DAC::Value(1000));
+	auto const other_words = cache.get_board_words(board);
+	EXPECT_NE(words, other_words);
+	EXPECT_EQ(2, cache.get_statistics().misses);
+
+	// equal configurations share an entry
+	Board other_board;
+	other_board.set_parameter(Board::Parameter::syn_v_bias, DAC::Value(1000));
+	EXPECT_EQ(other_words, cache.get_board_words(other_board));
+	EXPECT_EQ(2, cache.get_statistics().hits);
+}
@@ -0,0 +1,222 @@
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "halco/hicann-dls/v2/coordinates.h"
+#include "haldls/v2/board.h"
+#include "haldls/v2/capmem.h"
+#include "haldls/v2/chip.h"
+#include "haldls/v2/playback.h"
+#include "stadls/sha256.h"
+#include "stadls/v2/local_board_control.h"
+#include "stadls/v2/quick_queue.h"
+
+using namespace halco::common;
+using namespace halco::hicann_dls::v2;
+using namespace haldls::v2;
+using namespace stadls::v2;
+
+namespace {
+
+QuickQueueRequest create_test_request(Chip const& chip)
+{
+	PlaybackProgramBuilder builder;
+	builder.halt();
+	auto program = builder.done();
+	return create_request(Board(), chip, program);
+}
+
+} // namespace
+
+TEST(Sha256, Digest)
+{
+	stadls::Sha256 sha;
+	EXPECT_EQ(
+		(stadls::Sha256::digest_type{0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14,
+		                             0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+		                             0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,
+		                             0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55}),
+		sha.digest());
+
+	std::string const message("abc");
+	sha.update(message.cbegin(), message.cend());
+	EXPECT_EQ(
+		(stadls::Sha256::digest_type{0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+		                             0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		                             0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+		                             0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad}),
+		sha.digest());
+}
+
+TEST(QuickQueue, ConfigurationDigest)
+{
+	Chip chip;
+	auto const req = create_test_request(chip);
+	EXPECT_EQ(quick_queue_configuration_digest(req), req.configuration_digest);
+	EXPECT_EQ(req.configuration_digest, create_test_request(chip).configuration_digest);
+
+	// the playback program is not part of the configuration
+	auto other_program = req;
+	other_program.playback_program_bytes.clear();
+	EXPECT_EQ(req.configuration_digest, quick_queue_configuration_digest(other_program));
+
+	auto other_board = req;
+	ASSERT_FALSE(other_board.board_words.empty());
+	++other_board.board_words.front().value;
+	EXPECT_NE(req.configuration_digest, quick_queue_configuration_digest(other_board));
+
+	auto capmem = chip.get_capmem();
+	capmem.set(CapMemCellOnDLS(Enum(3)), CapMemCell::Value(123));
+	chip.set_capmem(capmem);
+	EXPECT_NE(req.configuration_digest, create_test_request(chip).configuration_digest);
+}
+
+TEST(QuickQueue, CapMemWords)
+{
+	Board board;
+	Chip const chip;
+	PlaybackProgramBuilder builder;
+	builder.halt();
+	auto program = builder.done();
+	auto const req = create_request(board, chip, program);
+	EXPECT_EQ(get_capmem_words(board, chip), req.chip_capmem_words);
+
+	// the board DACs supplying the cap-mem are part of its analog configuration
+	board.set_parameter(Board::Parameter::capmem_i_ref, DAC::Value(100));
+	EXPECT_NE(req.chip_capmem_words, get_capmem_words(board, chip));
+
+	board = Board();
+	board.set_parameter(Board::Parameter::syn_v_bias, DAC::Value(100));
+	EXPECT_EQ(req.chip_capmem_words, get_capmem_words(board, chip));
+}
+
+TEST(QuickQueue, OmitConfiguration)
+{
+	auto const req = create_test_request(Chip());
+	auto omitted = req;
+	omitted.omit_configuration();
+	EXPECT_TRUE(omitted.configuration_omitted);
+	EXPECT_TRUE(omitted.board_addresses.empty());
+	EXPECT_TRUE(omitted.board_words.empty());
+	EXPECT_TRUE(omitted.chip_program_bytes.empty());
+	EXPECT_TRUE(omitted.chip_capmem_words.empty());
+	EXPECT_EQ(req.configuration_digest, omitted.configuration_digest);
+	EXPECT_EQ(req.playback_program_bytes, omitted.playback_program_bytes);
+}
+
+TEST(QuickQueue, ConfigurationMissRoundTrip)
+{
+	// user data has to be authenticated, which requires a running munge daemon if enabled
+	try {
+		quick_queue_user_data();
+	} catch (std::runtime_error const&) {
+		return;
+	}
+
+	QuickQueueWorker worker("mock");
+	worker.set_mock_mode(true);
+	worker.setup();
+
+	auto req = create_test_request(Chip());
+	auto omitted = req;
+	omitted.omit_configuration();
+
+	omitted.user_data = quick_queue_user_data();
+	EXPECT_TRUE(worker.work(omitted).configuration_miss);
+	EXPECT_EQ(1, worker.get_configuration_cache_statistics().misses);
+
+	// resent including the configuration
+	req.user_data = quick_queue_user_data();
+	EXPECT_FALSE(worker.work(req).configuration_miss);
+	EXPECT_EQ(1, worker.get_configuration_cache_statistics().entries);
+
+	omitted.user_data = quick_queue_user_data();
+	EXPECT_FALSE(worker.work(omitted).configuration_miss);
+	EXPECT_EQ(1, worker.get_configuration_cache_statistics().hits);
+
+	// configurations not matching their digest are rejected
+	++req.board_words.front().value;
+	req.user_data = quick_queue_user_data();
+	EXPECT_THROW(worker.work(req), std::invalid_argument);
+
+	worker.teardown();
+}
+
+TEST(QuickQueue, CompressionLevel)
+{
+	auto req = create_test_request(Chip());
+	EXPECT_THROW(req.compress(-1), std::invalid_argument);
+	EXPECT_THROW(req.compress(1000), std::invalid_argument);
+	if (!quick_queue_compression_available()) {
+		EXPECT_THROW(req.compress(1), std::invalid_argument);
+	}
+	EXPECT_EQ(0, req.compression_level);
+
+	// a level of zero leaves the request uncompressed
+	auto const original = req;
+	req.compress(0);
+	EXPECT_EQ(0, req.compression_level);
+	EXPECT_EQ(original.chip_program_bytes, req.chip_program_bytes);
+
+	QuickQueueResponse response;
+	EXPECT_THROW(response.compress(-1), std::invalid_argument);
+	EXPECT_THROW(response.compress(1000), std::invalid_argument);
+}
+
+TEST(QuickQueue, CompressRequest)
+{
+	if (!quick_queue_compression_available()) {
+		return;
+	}
+
+	auto const original = create_test_request(Chip());
+	auto req = original;
+	req.compress(3);
+	EXPECT_EQ(3, req.compression_level);
+	EXPECT_FALSE(req.compressed_payload.empty());
+	EXPECT_TRUE(req.chip_program_bytes.empty());
+	EXPECT_TRUE(req.playback_program_bytes.empty());
+	EXPECT_THROW(req.compress(3), std::logic_error);
+
+	// the configuration is part of the compressed payload
+	EXPECT_THROW(req.omit_configuration(), std::logic_error);
+	EXPECT_FALSE(req.configuration_omitted);
+
+	req.decompress();
+	EXPECT_EQ(0, req.compression_level);
+	EXPECT_TRUE(req.compressed_payload.empty());
+	EXPECT_EQ(original.chip_program_bytes, req.chip_program_bytes);
+	EXPECT_EQ(original.playback_program_bytes, req.playback_program_bytes);
+	EXPECT_EQ(quick_queue_configuration_digest(original), quick_queue_configuration_digest(req));
+}
+
+TEST(QuickQueue, CompressResponse)
+{
+	if (!quick_queue_compression_available()) {
+		return;
+	}
+
+	QuickQueueResponse response;
+	for (std::size_t ii = 0; ii < 1000; ++ii) {
+		response.result_bytes.push_back(static_cast<instruction_word_type>(ii % 7));
+	}
+	auto const original = response;
+	response.compress(3);
+	EXPECT_EQ(3, response.compression_level);
+	EXPECT_TRUE(response.result_bytes.empty());
+	EXPECT_LT(response.compressed_payload.size(), original.result_bytes.size());
+	EXPECT_THROW(response.compress(3), std::logic_error);
+
+	response.decompress();
+	EXPECT_EQ(0, response.compression_level);
+	EXPECT_EQ(original.result_bytes, response.result_bytes);
+
+	// Frame header of a single segment frame announcing a content size of 1 TiB, which is
+	// rejected prior to allocating memory for it
+	QuickQueueResponse oversized;
+	oversized.compression_level = 3;
+	oversized.compressed_payload = {0x28, 0xb5, 0x2f, 0xfd, 0xe0, 0x00, 0x00,
+	                                0x00, 0x00, 0x00, 0x01, 0x00, 0x00};
+	EXPECT_THROW(oversized.decompress(), std::runtime_error);
+}
@@ -84,3 +84,21 @@ TEST(SpikeRouter, Encode)
 
 	EXPECT_THAT(data, ::testing::ElementsAreArray(ref_data));
 }
+
+TEST(Board, WriteEncode)
+{
+	Board config;
+	Unique const coord;
+
+	typedef std::vector<ocp_word_type> ocp_words_type;
+	ocp_words_type ocp_data;
+	visit_preorder(config, coord, stadls::EncodeVisitor<ocp_words_type>{ocp_data});
+	EXPECT_EQ(detail::ConfigSizeInWords<Board>::value, ocp_data.size());
+
+	typedef std::vector<std::pair<ocp_address_type, ocp_word_type> > data_type;
+	data_type data;
+	visit_preorder(config, coord, stadls::WriteEncodeVisitor<data_type>{data});
+	ASSERT_EQ(ocp_data.size(), data.size());
+	for (size_t ii = 0; ii < data.size(); ++ii)
+		EXPECT_EQ(ocp_data[ii].value, data[ii].second.value);
+}
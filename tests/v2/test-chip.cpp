@@ -2,6 +2,7 @@
 
 #include "haldls/v2/chip.h"
 #include "halco/common/iter_all.h"
+#include "stadls/visitors.h"
 
 using namespace haldls::v2;
 using namespace halco::hicann_dls::v2;
@@ -166,3 +167,31 @@ TEST(Chip, General)
 	ASSERT_FALSE(chip.get_buffered_readout_neuron());
 
 }
+
+TEST(Chip, WriteEncode)
+{
+	Chip chip;
+	Unique const coord;
+
+	typedef std::vector<hardware_address_type> addresses_type;
+	addresses_type addresses;
+	visit_preorder(chip, coord, stadls::WriteAddressVisitor<addresses_type>{addresses});
+	typedef std::vector<hardware_word_type> words_type;
+	words_type words;
+	visit_preorder(chip, coord, stadls::EncodeVisitor<words_type>{words});
+
+	EXPECT_EQ(detail::ConfigSizeInWords<Chip>::value, words.size());
+
+	typedef std::vector<std::pair<hardware_address_type, hardware_word_type> > data_type;
+	data_type data;
+	data.reserve(detail::ConfigSizeInWords<Chip>::value);
+	auto const capacity = data.capacity();
+	visit_preorder(chip, coord, stadls::WriteEncodeVisitor<data_type>{data});
+	EXPECT_EQ(capacity, data.capacity());
+
+	ASSERT_EQ(words.size(), data.size());
+	for (size_t ii = 0; ii < data.size(); ++ii) {
+		EXPECT_EQ(addresses[ii], data[ii].first);
+		EXPECT_EQ(words[ii], data[ii].second);
+	}
+}
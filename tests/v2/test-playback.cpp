@@ -0,0 +1,316 @@
+#include <bitset>
+#include <chrono>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "halco/hicann-dls/v2/coordinates.h"
+#include "haldls/v2/capmem.h"
+#include "haldls/v2/chip.h"
+#include "haldls/v2/neuron.h"
+#include "haldls/v2/playback.h"
+#include "haldls/v2/spike.h"
+
+using namespace haldls::v2;
+using namespace halco::hicann_dls::v2;
+using namespace halco::common;
+
+TEST(PlaybackProgramBuilder, WriteDiffUnchanged)
+{
+	Chip const chip;
+
+	PlaybackProgramBuilder builder;
+	builder.write_diff(Unique(), chip, chip);
+	builder.halt();
+	auto const program = builder.done();
+
+	builder.halt();
+	auto const empty_program = builder.done();
+
+	EXPECT_EQ(empty_program.dump_program(), program.dump_program());
+}
+
+TEST(PlaybackProgramBuilder, WriteDiffLeaf)
+{
+	CapMemCellOnDLS const cell(Enum(3));
+	CapMemCell const previous;
+	CapMemCell const next(CapMemCell::Value(123));
+
+	PlaybackProgramBuilder builder;
+	builder.write_diff(cell, previous, next);
+	builder.halt();
+	auto const program = builder.done();
+
+	builder.write(cell, next);
+	builder.halt();
+	auto const reference_program = builder.done();
+
+	EXPECT_EQ(reference_program.dump_program(), program.dump_program());
+}
+
+TEST(PlaybackProgramBuilder, WriteDiffChip)
+{
+	Chip const previous;
+	Chip next = previous;
+
+	SynapseOnDLS const synapse(Enum(17));
+	auto synapse_config = next.get_synapse(synapse);
+	synapse_config.set_weight(SynapseBlock::Synapse::Weight(42));
+	next.set_synapse(synapse, synapse_config);
+
+	PlaybackProgramBuilder builder;
+	builder.write_diff(Unique(), previous, next);
+	builder.halt();
+	auto const diff_program = builder.done();
+
+	builder.write(Unique(), next);
+	builder.halt();
+	auto const full_program = builder.done();
+
+	builder.halt();
+	auto const empty_program = builder.done();
+
+	EXPECT_NE(empty_program.dump_program(), diff_program.dump_program());
+	EXPECT_LT(diff_program.dump_program().size(), full_program.dump_program().size());
+}
+
+TEST(PlaybackProgramBuilder, ReadRange)
+{
+	std::vector<NeuronOnDLS> const neurons{NeuronOnDLS(3), NeuronOnDLS(0), NeuronOnDLS(17)};
+
+	PlaybackProgramBuilder builder;
+	auto const ticket = builder.read_range<NeuronDigitalConfig>(neurons);
+	builder.halt();
+	auto const program = builder.done();
+
+	for (auto const& neuron : neurons)
+		builder.read<NeuronDigitalConfig>(neuron);
+	builder.halt();
+	auto const reference_program = builder.done();
+
+	EXPECT_EQ(reference_program.dump_program(), program.dump_program());
+
+	// No data available yet
+	EXPECT_THROW(std::ignore = program.get(ticket), std::runtime_error);
+	EXPECT_THROW(std::ignore = program.get_words(ticket), std::runtime_error);
+	EXPECT_THROW(std::ignore = reference_program.get(ticket), std::invalid_argument);
+}
+
+TEST(PlaybackProgramBuilder, FireSpikeTrain)
+{
+	typedef SynapseBlock::Synapse::Address address_type;
+	std::vector<PlaybackSpike> const spikes{
+		PlaybackSpike(200, address_type(3), SynapseDriverOnDLS(1)),
+		PlaybackSpike(100, address_type(5), SynapseDriverOnDLS(2)),
+		PlaybackSpike(200, address_type(3), SynapseDriverOnDLS(4)),
+		PlaybackSpike(200, address_type(7), SynapseDriverOnDLS(4)),
+		PlaybackSpike(200, address_type(3), SynapseDriverOnDLS(4))};
+
+	PlaybackProgramBuilder builder;
+	builder.fire_spike_train(spikes);
+	builder.halt();
+	auto const program = builder.done();
+
+	std::bitset<SynapseDriverOnDLS::size> mask;
+	mask.set(1);
+	mask.set(4);
+	builder.wait_until(100);
+	builder.fire(SynapseDriverOnDLS(2), address_type(5));
+	builder.wait_until(200);
+	builder.fire(mask, address_type(3));
+	builder.fire(SynapseDriverOnDLS(4), address_type(7));
+	builder.halt();
+	auto const reference_program = builder.done();
+
+	EXPECT_EQ(reference_program.dump_program(), program.dump_program());
+}
+
+TEST(PlaybackProgramBuilder, WritePatchable)
+{
+	SynapseBlockOnDLS const synapse_block_coord(Enum(5));
+	SynapseBlock synapse_block;
+
+	PlaybackProgramBuilder builder;
+	builder.set_time(0);
+	auto const ticket = builder.write_patchable(synapse_block_coord, synapse_block);
+	builder.wait_for(100);
+	builder.halt();
+	auto program = builder.done();
+	auto const serial_number = program.serial_number();
+
+	SynapseBlock::Synapse synapse;
+	synapse.set_weight(SynapseBlock::Synapse::Weight(42));
+	synapse_block.set_synapse(SynapseOnSynapseBlock(1), synapse);
+
+	builder.set_time(0);
+	builder.write(synapse_block_coord, synapse_block);
+	builder.wait_for(100);
+	builder.halt();
+	auto const reference_program = builder.done();
+
+	EXPECT_NE(reference_program.dump_program(), program.dump_program());
+	EXPECT_TRUE(program.patched_byte_ranges().empty());
+
+	program.patch(ticket, synapse_block);
+	EXPECT_EQ(reference_program.dump_program(), program.dump_program());
+	EXPECT_EQ(serial_number, program.serial_number());
+	EXPECT_FALSE(program.patched_byte_ranges().empty());
+
+	EXPECT_THROW(builder.done().patch(ticket, synapse_block), std::invalid_argument);
+}
+
+TEST(PlaybackProgram, PatchVersion)
+{
+	SynapseBlockOnDLS const synapse_block_coord(Enum(5));
+	SynapseBlock synapse_block;
+
+	PlaybackProgramBuilder builder;
+	auto const ticket = builder.write_patchable(synapse_block_coord, synapse_block);
+	builder.halt();
+	auto program = builder.done();
+	auto const version = program.patch_version();
+	ASSERT_TRUE(program.patched_byte_range_count(version));
+	EXPECT_EQ(0, *program.patched_byte_range_count(version));
+
+	SynapseBlock::Synapse synapse;
+	synapse.set_weight(SynapseBlock::Synapse::Weight(42));
+	synapse_block.set_synapse(SynapseOnSynapseBlock(1), synapse);
+	program.patch(ticket, synapse_block);
+	EXPECT_NE(version, program.patch_version());
+	ASSERT_TRUE(program.patched_byte_range_count(version));
+	EXPECT_EQ(0, *program.patched_byte_range_count(version));
+	EXPECT_EQ(
+		program.patched_byte_ranges().size(),
+		*program.patched_byte_range_count(program.patch_version()));
+
+	// copies do not share the versions of the original
+	auto const copy = program;
+	EXPECT_NE(program.patch_version(), copy.patch_version());
+	EXPECT_FALSE(copy.patched_byte_range_count(version));
+	EXPECT_FALSE(copy.patched_byte_range_count(program.patch_version()));
+	EXPECT_FALSE(program.patched_byte_range_count(copy.patch_version()));
+}
+
+TEST(PlaybackProgram, Concat)
+{
+	PlaybackProgramBuilder builder;
+	builder.set_time(0);
+	builder.read<CapMemCell>(CapMemCellOnDLS(Enum(1)));
+	builder.halt();
+	auto const first = builder.done();
+
+	builder.set_time(0);
+	builder.wait_until(100);
+	auto const ticket = builder.read<CapMemCell>(CapMemCellOnDLS(Enum(2)));
+	auto const vector_ticket = builder.read_range<CapMemCell>(
+		{CapMemCellOnDLS(Enum(3)), CapMemCellOnDLS(Enum(4))});
+	builder.halt();
+	auto const second = builder.done();
+
+	auto const program = PlaybackProgram::concat({first, second});
+	EXPECT_NE(first.serial_number(), program.serial_number());
+	EXPECT_NE(second.serial_number(), program.serial_number());
+	EXPECT_FALSE(program.instruction_byte_blocks().empty());
+
+	// Ticket is translated to the combined program, no data available yet
+	auto const rebased_ticket = program.rebase(ticket);
+	EXPECT_THROW(std::ignore = program.get(ticket), std::invalid_argument);
+	EXPECT_THROW(std::ignore = program.get(rebased_ticket), std::runtime_error);
+	EXPECT_THROW(std::ignore = first.rebase(ticket), std::invalid_argument);
+
+	auto const rebased_vector_ticket = program.rebase(vector_ticket);
+	EXPECT_THROW(std::ignore = program.get(vector_ticket), std::invalid_argument);
+	EXPECT_THROW(std::ignore = program.get(rebased_vector_ticket), std::runtime_error);
+	EXPECT_THROW(std::ignore = first.rebase(vector_ticket), std::invalid_argument);
+
+	EXPECT_THROW(std::ignore = program.get_spikes(program.serial_number()), std::invalid_argument);
+
+	builder.set_time(0);
+	auto const unterminated = builder.done();
+	EXPECT_THROW(PlaybackProgram::concat({first, unterminated}), std::invalid_argument);
+}
+
+TEST(PlaybackProgramBuilder, SplitIntoSegments)
+{
+	PlaybackProgramBuilder builder;
+	EXPECT_EQ(0u, builder.instruction_byte_size());
+	builder.write(CapMemOnDLS(), CapMem());
+	auto const write_size = builder.instruction_byte_size();
+	EXPECT_LT(0u, write_size);
+	auto const single_program = builder.done();
+	EXPECT_EQ(1u, single_program.segment_count());
+	EXPECT_EQ(
+		single_program.instruction_byte_blocks(),
+		single_program.segment_instruction_byte_blocks(0));
+
+	builder.set_max_segment_size(2 * write_size);
+	builder.set_time(0);
+	for (size_t ii = 0; ii < 3; ++ii) {
+		builder.write(CapMemOnDLS(), CapMem());
+		builder.wait_for(10);
+	}
+	auto const ticket = builder.read<CapMemCell>(CapMemCellOnDLS(Enum(2)));
+	EXPECT_LT(0u, builder.result_byte_size());
+	builder.halt();
+	auto const program = builder.done();
+	EXPECT_EQ(3u, program.segment_count());
+	EXPECT_THROW(program.segment_instruction_byte_blocks(3), std::invalid_argument);
+	EXPECT_THROW(std::ignore = program.get(ticket), std::runtime_error);
+	EXPECT_EQ(2 * write_size, builder.get_max_segment_size());
+
+	// Without known time there is no location to split at
+	for (size_t ii = 0; ii < 3; ++ii) {
+		builder.write(CapMemOnDLS(), CapMem());
+		builder.wait_for(10);
+	}
+	builder.halt();
+	EXPECT_THROW(builder.done(), std::logic_error);
+}
+
+TEST(PlaybackProgram, EstimatedDuration)
+{
+	PlaybackProgramBuilder builder;
+	builder.halt();
+	EXPECT_EQ(std::chrono::microseconds(0), builder.done().estimated_duration());
+
+	builder.set_time(0);
+	builder.wait_until(96 * 100);
+	// Time already passed
+	builder.wait_until(96 * 50);
+	builder.wait_for(96 * 20);
+	builder.set_time(96 * 1000);
+	builder.wait_until(96 * 1010);
+	builder.halt();
+	EXPECT_EQ(std::chrono::microseconds(130), builder.done().estimated_duration());
+}
+
+TEST(PlaybackProgram, AltersCapMem)
+{
+	PlaybackProgramBuilder builder;
+	builder.read<CapMemCell>(CapMemCellOnDLS(Enum(1)));
+	builder.write(NeuronOnDLS(0), NeuronDigitalConfig());
+	builder.halt();
+	auto const digital = builder.done();
+	EXPECT_FALSE(digital.alters_capmem());
+
+	builder.write(CapMemCellOnDLS(Enum(1)), CapMemCell(CapMemCell::Value(123)));
+	builder.halt();
+	auto const analog = builder.done();
+	EXPECT_TRUE(analog.alters_capmem());
+
+	// Unchanged containers are not written
+	CapMem const capmem;
+	builder.write_diff(CapMemOnDLS(), capmem, capmem);
+	builder.halt();
+	EXPECT_FALSE(builder.done().alters_capmem());
+
+	builder.write(Unique(), Chip());
+	builder.halt();
+	EXPECT_TRUE(builder.done().alters_capmem());
+
+	builder.set_time(0);
+	builder.halt();
+	auto const other = builder.done();
+	EXPECT_TRUE(PlaybackProgram::concat({other, analog}).alters_capmem());
+	EXPECT_FALSE(PlaybackProgram::concat({other, digital}).alters_capmem());
+}